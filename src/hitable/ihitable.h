@@ -1,16 +1,25 @@
 #ifndef I_HITABLE_H
 #define I_HITABLE_H
 
+#include <cstdint>
 #include <memory>
 
+#include "math/affine.h"
 #include "scene/ray.h"
 #include "spatial/aabb.h"
 
 namespace rt {
 	class IMaterial;
+	class IHitable;
+	class LightList;
 
 	/**
-	 * structure holding the data of the intersection
+	 * structure holding the data of the intersection. the material is
+	 * owned by the hitables of the scene, thus records can be copied
+	 * without touching any reference counts.
+	 * intersect() only fills t and the fields that identify the hit, while
+	 * the remaining surface data is computed by interaction() once the
+	 * closest hit is known
 	 */
 	struct HitRecord {
 		double t;
@@ -18,7 +27,12 @@ namespace rt {
 		vec3 normal;
 		float u, v;
 		vec3 lp;
-		std::shared_ptr<IMaterial> material;
+		const IMaterial* material;
+
+		const IHitable* object;
+		const IHitable* instance;
+		uint32_t primitive;
+		double b1, b2;
 	};
 
 	/**
@@ -35,13 +49,65 @@ namespace rt {
 		 * @return true if the ray intersects the hitable in the given interval, false otherwise
 		 */
 		virtual bool hit(const ray& r, double tMin, double tMax, HitRecord& rec) const = 0;
+		/**
+		 * checks for an intersection like hit() but only determines t and which object
+		 * and primitive has been hit. the surface data is computed afterwards by
+		 * interaction(). hitables without a lean test fall back to a full hit
+		 * @param r - ray to test the intersection for
+		 * @param tmin - minimal allowed parameter t
+		 * @param tmax - maximal allowed parameter t
+		 * @param rec - intersection information of the hitable
+		 * @return true if the ray intersects the hitable in the given interval, false otherwise
+		 */
+		virtual bool intersect(const ray& r, double tMin, double tMax, HitRecord& rec) const {
+			if (!hit(r, tMin, tMax, rec)) return false;
+			rec.object = nullptr;
+			rec.instance = nullptr;
+			return true;
+		}
+		/**
+		 * computes the surface data of a hit found by intersect()
+		 * @param r - ray that has been used for the intersection
+		 * @param rec - intersection information that gets completed
+		 */
+		virtual void interaction(const ray& /*r*/, HitRecord& /*rec*/) const { }
+		/**
+		 * checks if anything blocks the ray in the interval [tmin, tmax]. the
+		 * test stops at the first hit that is found, which doesn't have to be
+		 * the closest one, and never computes any surface data
+		 * @param r - ray to test the intersection for
+		 * @param tmin - minimal allowed parameter t
+		 * @param tmax - maximal allowed parameter t
+		 * @return true if the ray intersects the hitable in the given interval, false otherwise
+		 */
+		virtual bool occluded(const ray& r, double tMin, double tMax) const {
+			HitRecord rec;
+			return intersect(r, tMin, tMax, rec);
+		}
 		/**
 		 * retrieves the axis aligned bounding box of a hitable
 		 * @param box - the retrieved bounding box
 		 * @return true if the hitable has a bounding box, false otherwise
 		 */
 		virtual bool boundingbox(aabb& box) const = 0;
+		/**
+		 * adds the emissive surfaces of the hitable to the list of lights
+		 * @param lights - list the lights are added to
+		 * @param transform - transformation from the space of the hitable to world space
+		 * @param instance - instance that contains the hitable or nullptr
+		 */
+		virtual void collect_lights(LightList& /*lights*/, const affine& /*transform*/, const IHitable* /*instance*/) const { }
 	};
+
+	/**
+	 * computes the surface data of the closest hit found by intersect()
+	 * @param r - ray that has been used for the intersection
+	 * @param rec - intersection information that gets completed
+	 */
+	inline void complete_interaction(const ray& r, HitRecord& rec) {
+		if      (rec.instance != nullptr) rec.instance->interaction(r, rec);
+		else if (rec.object   != nullptr) rec.object->interaction(r, rec);
+	}
 }
 
 #endif//I_HITABLE_H
\ No newline at end of file
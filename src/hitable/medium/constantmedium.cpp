@@ -17,13 +17,13 @@ bool rt::ConstantMedium::hit(const ray& r, double tmin, double tmax, HitRecord&
 
 			// determine probability of a hit
 			float distance = (record2.t - record1.t) * length(r.dir);
-			float hitdistance = -(1.f / m_density) * std::log(drand());
+			float hitdistance = -(1.f / m_density) * std::log(1.0 - drand());
 			if (hitdistance < distance) {
 				rec.t = record1.t + hitdistance / length(r.dir);
 				rec.p = r.position(rec.t);
 				rec.lp = record1.lp;
 				rec.normal = vec3(1, 0, 0); // doesn't matter
-				rec.material = m_phasefunction;
+				rec.material = m_phasefunction.get();
 				return true;
 			}
 		}
@@ -6,51 +6,91 @@ rt::Cube::Cube(vec3 pos, float width, float height, float depth, std::shared_ptr
 }
 
 bool rt::Cube::hit(const ray& r, double tmin, double tmax, HitRecord& record) const {
-	bool anyhit = m_rectangles->hit(r, tmin, tmax, record);
-	if (anyhit) {
-		record.material = m_material;
-		record.lp = record.p - m_position;
+	if (intersect(r, tmin, tmax, record)) {
+		interaction(r, record);
+		return true;
 	}
-	return anyhit;
+
+	return false;
 }
-bool rt::Cube::boundingbox(aabb& box) const {
-	aabb tempbox;
-	if (m_rectangles->boundingbox(tempbox)) {
-		box = tempbox;
-		return true;
+bool rt::Cube::intersect(const ray& r, double tmin, double tmax, HitRecord& record) const {
+	if (!m_bounds.hit(r, tmin, tmax)) return false;
+
+	// find the closest face
+	bool anyhit = false;
+	uint32_t face = 0;
+	for (uint32_t i = 0; i < 6; ++i) {
+		if (m_faces[i].intersect(r, tmin, tmax, record)) {
+			tmax = record.t;
+			face = i;
+			anyhit = true;
+		}
 	}
+	if (!anyhit) return false;
+
+	// the primitive encodes the face and its triangle
+	record.object = this;
+	record.primitive = 2 * face + record.primitive;
+	return true;
+}
+bool rt::Cube::occluded(const ray& r, double tmin, double tmax) const {
+	if (!m_bounds.hit(r, tmin, tmax)) return false;
 
+	for (uint32_t i = 0; i < 6; ++i) {
+		if (m_faces[i].occluded(r, tmin, tmax)) return true;
+	}
 	return false;
 }
+void rt::Cube::interaction(const ray& r, HitRecord& record) const {
+	uint32_t face = record.primitive / 2;
+	record.primitive %= 2;
+	m_faces[face].interaction(r, record);
+	record.material = m_material.get();
+	record.lp = record.p - m_position;
+}
+bool rt::Cube::boundingbox(aabb& box) const {
+	box = m_bounds;
+	return true;
+}
 
 void rt::Cube::create_rectangles(bool invert) {
 	vec3 dx(m_width / 2.f, 0, 0);
 	vec3 dy(0, m_height / 2.f, 0);
 	vec3 dz(0, 0, m_depth / 2.f);
 
-	// initialize bvh
-	m_rectangles = std::make_shared<BVH>();
-
 	// create rectangles
 	if (!invert) {
-		m_rectangles->insert(std::make_shared<Rectangle>(m_position + dx, -dz, dy, nullptr));
-		m_rectangles->insert(std::make_shared<Rectangle>(m_position - dx,  dz, dy, nullptr));
+		m_faces[0] = Rectangle(m_position + dx, -dz, dy, m_material);
+		m_faces[1] = Rectangle(m_position - dx,  dz, dy, m_material);
 
-		m_rectangles->insert(std::make_shared<Rectangle>(m_position + dy, dx, -dz, nullptr));
-		m_rectangles->insert(std::make_shared<Rectangle>(m_position - dy, dx,  dz, nullptr));
+		m_faces[2] = Rectangle(m_position + dy, dx, -dz, m_material);
+		m_faces[3] = Rectangle(m_position - dy, dx,  dz, m_material);
 
-		m_rectangles->insert(std::make_shared<Rectangle>(m_position + dz,  dx, dy, nullptr));
-		m_rectangles->insert(std::make_shared<Rectangle>(m_position - dz, -dx, dy, nullptr));
+		m_faces[4] = Rectangle(m_position + dz,  dx, dy, m_material);
+		m_faces[5] = Rectangle(m_position - dz, -dx, dy, m_material);
 	}
 	else {
-		m_rectangles->insert(std::make_shared<Rectangle>(m_position + dx,  dz, dy, nullptr));
-		m_rectangles->insert(std::make_shared<Rectangle>(m_position - dx, -dz, dy, nullptr));
+		m_faces[0] = Rectangle(m_position + dx,  dz, dy, m_material);
+		m_faces[1] = Rectangle(m_position - dx, -dz, dy, m_material);
 
-		m_rectangles->insert(std::make_shared<Rectangle>(m_position + dy, dx,  dz, nullptr));
-		m_rectangles->insert(std::make_shared<Rectangle>(m_position - dy, dx, -dz, nullptr));
+		m_faces[2] = Rectangle(m_position + dy, dx,  dz, m_material);
+		m_faces[3] = Rectangle(m_position - dy, dx, -dz, m_material);
 
-		m_rectangles->insert(std::make_shared<Rectangle>(m_position + dz, -dx, dy, nullptr));
-		m_rectangles->insert(std::make_shared<Rectangle>(m_position - dz,  dx, dy, nullptr));
+		m_faces[4] = Rectangle(m_position + dz, -dx, dy, m_material);
+		m_faces[5] = Rectangle(m_position - dz,  dx, dy, m_material);
+	}
+
+	// surrounding box of all faces
+	m_bounds = aabb();
+	for (auto& face : m_faces) {
+		aabb box;
+		face.boundingbox(box);
+		m_bounds.surround(box);
+	}
+}
+void rt::Cube::collect_lights(LightList& lights, const affine& transform, const IHitable* instance) const {
+	// the primitive encodes the face and its triangle
+	for (uint32_t face = 0; face < 6; ++face) {
+		m_faces[face].collect_lights(lights, transform, instance, this, 2 * face);
 	}
-	m_rectangles->build();
 }
\ No newline at end of file
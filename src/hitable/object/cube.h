@@ -2,7 +2,6 @@
 #define CUBE_H
 
 #include "hitable/ihitable.h"
-#include "hitable/organization/bvh.h"
 #include "rectangle.h"
 
 namespace rt {
@@ -11,12 +10,17 @@ namespace rt {
 		Cube(vec3 pos, float width, float height, float depth, std::shared_ptr<IMaterial> mat, bool invert = false);
 
 		virtual bool hit(const ray& r, double tMin, double tMax, HitRecord& rec) const;
+		virtual bool intersect(const ray& r, double tMin, double tMax, HitRecord& rec) const override;
+		virtual bool occluded(const ray& r, double tMin, double tMax) const override;
+		virtual void interaction(const ray& r, HitRecord& rec) const override;
 		virtual bool boundingbox(aabb& box) const;
+		virtual void collect_lights(LightList& lights, const affine& transform, const IHitable* instance) const override;
 
 	private:
 		vec3 m_position;
 		float m_width, m_height, m_depth;
-		std::shared_ptr<BVH> m_rectangles;
+		Rectangle m_faces[6];
+		aabb m_bounds;
 		std::shared_ptr<IMaterial> m_material;
 
 		void create_rectangles(bool invert);
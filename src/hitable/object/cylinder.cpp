@@ -10,6 +10,15 @@ rt::Cylinder::Cylinder(const vec3& p1, const vec3& p2, float r, std::shared_ptr<
 };
 
 bool rt::Cylinder::hit(const ray& r, double tmin, double tmax, HitRecord& rec) const {
+	if (intersect(r, tmin, tmax, rec)) {
+		interaction(r, rec);
+		return true;
+	}
+
+	return false;
+}
+
+bool rt::Cylinder::intersect(const ray& r, double tmin, double tmax, HitRecord& rec) const {
 	// determine ray in the coordinate system of the cylinder
 	double ox = dot(r.o - m_p1, m_x);
 	double oy = dot(r.o - m_p1, m_y);
@@ -65,19 +74,25 @@ bool rt::Cylinder::hit(const ray& r, double tmin, double tmax, HitRecord& rec) c
 
 		if (!hit) return false;
 
-		// calculate intersection information
+		// the primitive tells whether a cap or the side has been hit
 		rec.t = t;
-		rec.p = r.position(rec.t);
-		vec3 pp = (iscap) ? m_p1 + 0.5*(m_p2 - m_p1) : m_p1 + dot(rec.p - m_p1, m_z) * m_z;
-		rec.normal = normalize(rec.p - pp);
-		rec.material = m_material;
-		texture_coordinates(rec.p, rec.u, rec.v);
-		rec.lp = rec.p - m_p1;
+		rec.object = this;
+		rec.instance = nullptr;
+		rec.primitive = (iscap) ? 1 : 0;
 		return true;
 	}
 
 	return false;
 };
+void rt::Cylinder::interaction(const ray& r, HitRecord& rec) const {
+	// calculate intersection information
+	rec.p = r.position(rec.t);
+	vec3 pp = (rec.primitive == 1) ? m_p1 + 0.5*(m_p2 - m_p1) : m_p1 + dot(rec.p - m_p1, m_z) * m_z;
+	rec.normal = normalize(rec.p - pp);
+	rec.material = m_material.get();
+	texture_coordinates(rec.p, rec.u, rec.v);
+	rec.lp = rec.p - m_p1;
+}
 
 bool rt::Cylinder::boundingbox(aabb& box) const {
 	// http://www.iquilezles.org/www/articles/diskbbox/diskbbox.htm
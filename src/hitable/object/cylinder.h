@@ -12,6 +12,8 @@ namespace rt {
 		Cylinder(const vec3& p1, const vec3& p2, float r, std::shared_ptr<IMaterial> mat);
 
 		virtual bool hit(const ray& r, double tMin, double tMax, HitRecord& rec) const;
+		virtual bool intersect(const ray& r, double tMin, double tMax, HitRecord& rec) const override;
+		virtual void interaction(const ray& r, HitRecord& rec) const override;
 		virtual bool boundingbox(aabb& box) const;
 
 	private:
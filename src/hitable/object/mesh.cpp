@@ -1,41 +1,258 @@
 #include "mesh.h"
 
-bool rt::Mesh::hit(const ray& r, double tmin, double tmax, HitRecord& rec) const {
-	if (bvh.hit(r, tmin, tmax, rec)) {
-		// mesh is already in local coordiantes
-		// thus the intersection point is in
-		// local coordinates as well
-		rec.lp = rec.p;
+#include "light/lightlist.h"
+#include "light/trianglelight.h"
+
+#include <chrono>
+#include <limits>
 
+namespace {
+	// maximum number of triangles in a leaf, a multiple of the packet width
+	const size_t MAX_LEAF_SIZE = 2 * rt::TRIANGLE_PACKET_WIDTH;
+	// depth after which the triangles are split at their median
+	const size_t MAX_DEPTH = 50;
+	// maximum depth of the traversal stack
+	const size_t MAX_STACK_SIZE = 128;
+}
+
+rt::Mesh::Mesh(std::vector<vec3> positions, std::vector<vec3> normals, std::vector<uint32_t> indices, std::shared_ptr<IMaterial> mat, BuilderType builder)
+	: m_positions(std::move(positions)), m_normals(std::move(normals)),
+	  m_indices(std::move(indices)), m_material(mat), m_builder(builder), m_statistics{ 0, 0, 0.0, 0.0 } {
+	build();
+}
+
+bool rt::Mesh::hit(const ray& r, double tmin, double tmax, HitRecord& rec) const {
+	if (intersect(r, tmin, tmax, rec)) {
+		interaction(r, rec);
 		return true;
 	}
 
 	return false;
-};
+}
+
+bool rt::Mesh::intersect(const ray& r, double tmin, double tmax, HitRecord& rec) const {
+	// mesh is empty
+	if (m_nodes.empty()) return false;
+
+	// precompute the ray data that is shared by all slab tests
+	double o[3], invdir[3];
+	bool negative[3];
+	for (size_t i = 0; i < 3; ++i) {
+		o[i] = r.o[i];
+		invdir[i] = 1.0 / r.dir[i];
+		negative[i] = invdir[i] < 0.0;
+	}
+
+	// the packets are tested in single precision
+	PacketRay packetray(r);
+	float ftmin = static_cast<float>(tmin);
+	float ftmax = (tmax < std::numeric_limits<float>::max()) ? static_cast<float>(tmax) : std::numeric_limits<float>::infinity();
+
+	// same traversal as the bvh, but the leaves store triangle packets
+	bool anyhit = false;
+	uint32_t triangle = 0;
+	float u = 0.f, v = 0.f;
+	uint32_t stack[MAX_STACK_SIZE];
+	size_t stacksize = 0;
+	uint32_t current = 0;
+	while (true) {
+		const BVH::LinearNode& node = m_nodes[current];
+		if (BVH::hit_node(node, o, invdir, tmin, tmax)) {
+			if (node.count > 0) {
+				// leaf node, the packets shrink ftmax to their closest hit
+				for (uint32_t i = node.offset; i < node.offset + node.count; ++i) {
+					if (m_packets[i].intersect(packetray, ftmin, ftmax, triangle, u, v)) {
+						tmax = ftmax;
+						anyhit = true;
+					}
+				}
+			}
+			else {
+				// visit the child that is closer along the split axis first
+				if (negative[node.axis]) {
+					stack[stacksize++] = current + 1;
+					current = node.offset;
+				}
+				else {
+					stack[stacksize++] = node.offset;
+					current = current + 1;
+				}
+				continue;
+			}
+		}
+
+		if (stacksize == 0) break;
+		current = stack[--stacksize];
+	}
+
+	// the record is only written for the closest hit
+	if (!anyhit) return false;
+	rec.t = tmax;
+	rec.object = this;
+	rec.instance = nullptr;
+	rec.primitive = triangle;
+	rec.b1 = u;
+	rec.b2 = v;
+	return true;
+}
+
+bool rt::Mesh::occluded(const ray& r, double tmin, double tmax) const {
+	// mesh is empty
+	if (m_nodes.empty()) return false;
+
+	double o[3], invdir[3];
+	for (size_t i = 0; i < 3; ++i) {
+		o[i] = r.o[i];
+		invdir[i] = 1.0 / r.dir[i];
+	}
+
+	PacketRay packetray(r);
+	float ftmin = static_cast<float>(tmin);
+	float ftmax = (tmax < std::numeric_limits<float>::max()) ? static_cast<float>(tmax) : std::numeric_limits<float>::infinity();
+
+	// the order of the children doesn't matter, any hit ends the traversal
+	uint32_t stack[MAX_STACK_SIZE];
+	size_t stacksize = 0;
+	uint32_t current = 0;
+	while (true) {
+		const BVH::LinearNode& node = m_nodes[current];
+		if (BVH::hit_node(node, o, invdir, tmin, tmax)) {
+			if (node.count > 0) {
+				for (uint32_t i = node.offset; i < node.offset + node.count; ++i) {
+					if (m_packets[i].occluded(packetray, ftmin, ftmax)) return true;
+				}
+			}
+			else {
+				stack[stacksize++] = node.offset;
+				current = current + 1;
+				continue;
+			}
+		}
+
+		if (stacksize == 0) break;
+		current = stack[--stacksize];
+	}
+
+	return false;
+}
+
+void rt::Mesh::interaction(const ray& r, HitRecord& rec) const {
+	const uint32_t* vertices = &m_indices[3 * rec.primitive];
+
+	// interpolate the vertex normals, the weights of the
+	// three vertices are (1-u-v), u and v
+	double w = 1.0 - rec.b1 - rec.b2;
+	vec3 n = w * m_normals[vertices[0]] + rec.b1 * m_normals[vertices[1]] + rec.b2 * m_normals[vertices[2]];
+
+	// mesh is already in local coordiantes thus the
+	// intersection point is the local point as well
+	rec.p = r.position(rec.t);
+	rec.normal = rt::normalize(n);
+	// meshes have no texture coordinates
+	rec.u = 0;
+	rec.v = 0;
+	rec.lp = rec.p;
+	rec.material = m_material.get();
+}
+
 bool rt::Mesh::boundingbox(aabb& box) const {
-	return bvh.boundingbox(box);
+	// early return if mesh is empty
+	if (m_nodes.empty()) return false;
+
+	box = m_bounds;
+	return true;
+}
+
+void rt::Mesh::collect_lights(LightList& lights, const affine& transform, const IHitable* instance) const {
+	if (m_material == nullptr || !m_material->is_emissive()) return;
+
+	for (uint32_t i = 0; i < triangle_count(); ++i) {
+		vec3 a = transform_point(transform, m_positions[m_indices[3 * i + 0]]);
+		vec3 b = transform_point(transform, m_positions[m_indices[3 * i + 1]]);
+		vec3 c = transform_point(transform, m_positions[m_indices[3 * i + 2]]);
+		lights.add(std::make_shared<TriangleLight>(a, b, c, instance, this, i), instance, this, i);
+	}
 }
 
 void rt::Mesh::normalize() {
-	// normalize triangles
-	aabb bounds;
-	if (bvh.boundingbox(bounds)) {
-		float r = length(bounds.max() - bounds.min()) / 2.f;
-		vec3 center = bounds.center();
-		for (auto tri : triangles) {
-			tri->p1 = (tri->p1 - center) / r;
-			tri->p2 = (tri->p2 - center) / r;
-			tri->p3 = (tri->p3 - center) / r;
+	// normalize vertices
+	if (!m_nodes.empty()) {
+		float r = length(m_bounds.max() - m_bounds.min()) / 2.f;
+		vec3 center = m_bounds.center();
+		for (auto& p : m_positions) {
+			p = (p - center) / r;
+		}
+	}
+
+	// recompute hierarchy
+	build();
+}
+
+void rt::Mesh::build() {
+	m_nodes.clear();
+	m_packets.clear();
+	m_bounds = aabb();
+	m_statistics = { 0, 0, 0.0, 0.0 };
+
+	// start timer
+	auto starttime = std::chrono::high_resolution_clock::now();
+
+	// gather bounds and centroids of all triangles
+	size_t count = triangle_count();
+	std::vector<PrimitiveReference> references;
+	references.reserve(count);
+	for (size_t i = 0; i < count; ++i) {
+		aabb box;
+		box.extend(m_positions[m_indices[3 * i + 0]]);
+		box.extend(m_positions[m_indices[3 * i + 1]]);
+		box.extend(m_positions[m_indices[3 * i + 2]]);
+		references.push_back({ box, box.center(), static_cast<uint32_t>(i) });
+	}
+
+	// do nothing when mesh is empty
+	if (references.size() == 0) return;
+
+	// build the hierarchy, the leaves reference the triangles in the order of the references
+	BVHBuilder builder(MAX_LEAF_SIZE, MAX_DEPTH, m_builder);
+	std::vector<BuildNode> nodes = builder.build(references);
+	m_bounds = nodes[0].bounds;
+	m_nodes = BVH::flatten(nodes);
+
+	// pack the triangles of each leaf, afterwards the leaves
+	// reference a range of packets instead of triangles
+	for (auto& node : m_nodes) {
+		if (node.count == 0) continue;
+
+		uint32_t begin = node.offset, end = node.offset + node.count;
+		node.offset = static_cast<uint32_t>(m_packets.size());
+		for (uint32_t i = begin; i < end; i += TRIANGLE_PACKET_WIDTH) {
+			TrianglePacket packet;
+			for (uint32_t lane = 0; lane < TRIANGLE_PACKET_WIDTH && i + lane < end; ++lane) {
+				uint32_t index = references[i + lane].index;
+				packet.set(lane, m_positions[m_indices[3 * index + 0]], m_positions[m_indices[3 * index + 1]], m_positions[m_indices[3 * index + 2]], index);
+			}
+			m_packets.push_back(packet);
 		}
+		node.count = static_cast<uint16_t>(m_packets.size() - node.offset);
 	}
 
-	// recompute bvh
-	std::vector<std::shared_ptr<IHitable>> hitables(triangles.begin(), triangles.end());
-	bvh.insert_all(hitables);
-	bvh.build();
+	// collect statistics
+	auto endtime = std::chrono::high_resolution_clock::now();
+	std::chrono::duration<double> elapsedtime = endtime - starttime;
+	m_statistics.primitives = references.size();
+	m_statistics.nodes = m_nodes.size();
+	m_statistics.buildtime = elapsedtime.count();
+	m_statistics.sahcost = builder.sah_cost(nodes);
 }
 
-std::shared_ptr<rt::Mesh> rt::load_mesh(std::string filename, std::shared_ptr<IMaterial> mat, bool fliptriangle, bool normalize, bool smoothnormals) {
+void rt::Mesh::print_statistics() const {
+	std::string type = (m_builder == PARALLEL_SAH_BUILDER) ? "parallel sah" : "sah";
+	console::println("MESH  : " + std::to_string(triangle_count()) + " triangles, " + std::to_string(m_positions.size()) + " vertices");
+	console::println("BVH   : " + type + ", " + std::to_string(m_statistics.primitives) + " primitives, " + std::to_string(m_statistics.nodes) + " nodes");
+	console::println("BUILD : " + format_time(m_statistics.buildtime) + ", sah cost " + std::to_string(m_statistics.sahcost));
+}
+
+std::shared_ptr<rt::Mesh> rt::load_mesh(std::string filename, std::shared_ptr<IMaterial> mat, bool fliptriangle, bool normalize, bool smoothnormals, BuilderType builder) {
 	console::println("loading file " + filename);
 	
 	// open file stream
@@ -57,8 +274,8 @@ std::shared_ptr<rt::Mesh> rt::load_mesh(std::string filename, std::shared_ptr<IM
 	file.clear();
 	file.seekg(0);
 
-	std::vector<vec3> positions, normals, texturecoordinates;
-	std::vector<size_t> indices;
+	std::vector<vec3> positions, normals;
+	std::vector<uint32_t> indices;
 	size_t currentlinecount = 0;
 	while (std::getline(file, line)) {
 		// current progress
@@ -77,20 +294,6 @@ std::shared_ptr<rt::Mesh> rt::load_mesh(std::string filename, std::shared_ptr<IM
 			float z = stof(tokens.at(3));
 			positions.push_back(vec3(x, y, z));
 		}
-		/*
-		else if (tokens.at(0) == "vn") {
-			float x = stof(tokens.at(1));
-			float y = stof(tokens.at(2));
-			float z = stof(tokens.at(3));
-			normals.push_back(vec3(x, y, z));
-		}
-		else if (tokens.at(0) == "vt") {
-			float x = stof(tokens.at(1));
-			float y = stof(tokens.at(2));
-			float z = stof(tokens.at(3));
-			texturecoordinates.push_back(vec3(x, y, z));
-		}
-		*/
 		else if (tokens.at(0) == "f") {
 			size_t len = std::min(tokens.size(), size_t{4});
 			for (size_t i = 1; i < len; ++i) {
@@ -103,7 +306,7 @@ std::shared_ptr<rt::Mesh> rt::load_mesh(std::string filename, std::shared_ptr<IM
 				long idx = (vindex.empty()) ? 1 : stol(vindex);
 				while (idx <= 0) { idx = static_cast<long>(positions.size()) + idx; }
 				if (idx > positions.size() || idx < 0) console::println("Index out of bounds " + std::to_string(idx) + " " + std::to_string(positions.size()));
-				indices.push_back(idx);
+				indices.push_back(static_cast<uint32_t>(idx));
 			}
 		}
 	}
@@ -115,30 +318,25 @@ std::shared_ptr<rt::Mesh> rt::load_mesh(std::string filename, std::shared_ptr<IM
 	// define offsets
 	vec3 offset = (fliptriangle) ? vec3(0, 1, 2) : vec3(2, 1, 0);
 
-	// create triangles
-	std::vector<std::shared_ptr<Triangle>> triangles;
+	// create the index buffer with zero based indices
+	std::vector<uint32_t> triangles;
+	triangles.reserve(indices.size());
 	for (size_t i = 2; i < indices.size(); i += 3) {
 		console::progress("creating geometry  ", static_cast<double>(i) / (indices.size() - 1));
-		size_t idx1 = indices.at(i - static_cast<size_t>(offset.x)) - 1;
-		size_t idx2 = indices.at(i - static_cast<size_t>(offset.y)) - 1;
-		size_t idx3 = indices.at(i - static_cast<size_t>(offset.z)) - 1;
-		vec3 a = positions.at(idx1);
-		vec3 b = positions.at(idx2);
-		vec3 c = positions.at(idx3);
-		vec3 n1 = normals.at(idx1);
-		vec3 n2 = normals.at(idx2);
-		vec3 n3 = normals.at(idx3);
-		triangles.push_back(std::make_shared<Triangle>(a, b, c, n1, n2, n3, mat));
+		triangles.push_back(indices.at(i - static_cast<size_t>(offset.x)) - 1);
+		triangles.push_back(indices.at(i - static_cast<size_t>(offset.y)) - 1);
+		triangles.push_back(indices.at(i - static_cast<size_t>(offset.z)) - 1);
 	}
 
 	// create mesh and maybe normalize
-	auto mesh = std::make_shared<Mesh>(triangles, mat);
+	auto mesh = std::make_shared<Mesh>(std::move(positions), std::move(normals), std::move(triangles), mat, builder);
 	if (normalize) mesh->normalize();
+	mesh->print_statistics();
 	
 	return mesh;
 }
 
-void rt::calculate_normals(bool fliptriangle, const std::vector<size_t>& indices, const std::vector<vec3>& positions, std::vector<vec3>& normals) {
+void rt::calculate_normals(bool fliptriangle, const std::vector<uint32_t>& indices, const std::vector<vec3>& positions, std::vector<vec3>& normals) {
 	// make normals fit positions
 	normals.resize(positions.size());
 	
@@ -160,7 +358,7 @@ void rt::calculate_normals(bool fliptriangle, const std::vector<size_t>& indices
 		normals.at(idx3) = n;
 	}
 }
-void rt::calculate_smooth_normals(bool fliptriangle, const std::vector<size_t>& indices, const std::vector<vec3>& positions, std::vector<vec3>& normals) {
+void rt::calculate_smooth_normals(bool fliptriangle, const std::vector<uint32_t>& indices, const std::vector<vec3>& positions, std::vector<vec3>& normals) {
 	// make normals fit positions
 	normals.resize(positions.size());
 	
@@ -4,7 +4,6 @@
 #include <iostream>
 #include <fstream>
 #include <string>
-#include <string>
 #include <vector>
 
 #include "io/console.h"
@@ -12,33 +11,69 @@
 #include "hitable/ihitable.h"
 #include "math/constants.h"
 #include "math/vec3.h"
+#include "spatial/trianglepacket.h"
 #include "util/string.h"
-#include "triangle.h"
 
 namespace rt {
+	/**
+	 * indexed triangle mesh. positions and normals are shared by all
+	 * triangles, each triangle references its three vertices in the
+	 * index buffer. the leaves of the hierarchy store their triangles in
+	 * packets that are intersected at once, the mesh has a single material
+	 */
 	class Mesh : public IHitable {
 	public:
-		Mesh() {}
-		Mesh(std::vector<std::shared_ptr<Triangle>> triangles, std::shared_ptr<IMaterial> mat)
-			: triangles(triangles), material(mat) {
-			std::vector<std::shared_ptr<IHitable>> hitables(triangles.begin(), triangles.end());
-			bvh.insert_all(hitables);
-			bvh.build();
-		};
+		Mesh() : m_builder(SAH_BUILDER), m_statistics{ 0, 0, 0.0, 0.0 } {}
+		/**
+		 * @param positions - vertex positions
+		 * @param normals - vertex normals, one per position
+		 * @param indices - three vertex indices per triangle
+		 * @param mat - material of the whole mesh
+		 * @param builder - algorithm used to build the hierarchy
+		 */
+		Mesh(std::vector<vec3> positions, std::vector<vec3> normals, std::vector<uint32_t> indices, std::shared_ptr<IMaterial> mat, BuilderType builder = SAH_BUILDER);
 
 		virtual bool hit(const ray& r, double tMin, double tMax, HitRecord& rec) const override;
+		virtual bool intersect(const ray& r, double tMin, double tMax, HitRecord& rec) const override;
+		virtual bool occluded(const ray& r, double tMin, double tMax) const override;
+		virtual void interaction(const ray& r, HitRecord& rec) const override;
 		virtual bool boundingbox(aabb& box) const override;
+		virtual void collect_lights(LightList& lights, const affine& transform, const IHitable* instance) const override;
 
+		/**
+		 * centers the mesh at the origin and scales it to fit into the unit sphere
+		 */
 		void normalize();
+		/**
+		 * rebuilds the hierarchy over the triangles
+		 */
+		void build();
+		/**
+		 * prints the size of the mesh and the statistics of the last build
+		 */
+		void print_statistics() const;
+
+		/**
+		 * returns the number of triangles
+		 * @return number of triangles
+		 */
+		size_t triangle_count() const { return m_indices.size() / 3; }
+
+	private:
+		std::vector<vec3> m_positions, m_normals;
+		std::vector<uint32_t> m_indices;
+		std::shared_ptr<IMaterial> m_material;
 
-		BVH bvh;
-		std::vector<std::shared_ptr<Triangle>> triangles;
-		std::shared_ptr<IMaterial> material;
+		BuilderType m_builder;
+		BVH::BuildStatistics m_statistics;
+		std::vector<BVH::LinearNode> m_nodes;
+		std::vector<TrianglePacket> m_packets;
+		aabb m_bounds;
 	};
 
-	std::shared_ptr<Mesh> load_mesh(std::string filename, std::shared_ptr<IMaterial> mat, bool fliptriangle = false, bool normalize = false, bool smoothnormals = false);
-	void calculate_normals(bool fliptriangle, const std::vector<size_t>& indices, const std::vector<vec3>& positions, std::vector<vec3>& normals);
-	void calculate_smooth_normals(bool fliptriangle, const std::vector<size_t>& indices, const std::vector<vec3>& positions, std::vector<vec3>& normals);
+	std::shared_ptr<Mesh> load_mesh(std::string filename, std::shared_ptr<IMaterial> mat, bool fliptriangle = false, bool normalize = false, bool smoothnormals = false, BuilderType builder = SAH_BUILDER);
+	void calculate_normals(bool fliptriangle, const std::vector<uint32_t>& indices, const std::vector<vec3>& positions, std::vector<vec3>& normals);
+	void calculate_smooth_normals(bool fliptriangle, const std::vector<uint32_t>& indices, const std::vector<vec3>& positions, std::vector<vec3>& normals);
 }
 
 #endif//MESH_H
\ No newline at end of file
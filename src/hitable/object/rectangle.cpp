@@ -44,19 +44,34 @@ rt::Rectangle::Rectangle(vec3 p, vec3 right, vec3 up, std::shared_ptr<IMaterial>
 }
 
 bool rt::Rectangle::hit(const ray& r, double tMin, double tMax, HitRecord& rec) const {
-	HitRecord rec1, rec2;
-	bool hit1 = m_t1.hit(r, tMin, tMax, rec1);
-	bool hit2 = m_t2.hit(r, tMin, tMax, rec2);
+	if (intersect(r, tMin, tMax, rec)) {
+		interaction(r, rec);
+		return true;
+	}
 
-	if (hit1 && hit2) rec = (rec1.t < rec2.t) ? rec1 : rec2;
-	else if (hit1) rec = rec1;
-	else if (hit2) rec = rec2;
-	bool anyhit = hit1 || hit2;
+	return false;
+}
+bool rt::Rectangle::intersect(const ray& r, double tMin, double tMax, HitRecord& rec) const {
+	// the second triangle only has to be closer than the first hit
+	bool hit1 = m_t1.intersect(r, tMin, tMax, rec);
+	bool hit2 = m_t2.intersect(r, tMin, (hit1) ? rec.t : tMax, rec);
+	if (!hit1 && !hit2) return false;
 
-	// update local position of the intersection
-	if (anyhit) rec.lp = rec.p - m_position;
+	// remember which triangle has been hit
+	rec.object = this;
+	rec.primitive = (hit2) ? 1 : 0;
+	return true;
+}
+bool rt::Rectangle::occluded(const ray& r, double tMin, double tMax) const {
+	HitRecord rec;
+	return m_t1.intersect(r, tMin, tMax, rec) || m_t2.intersect(r, tMin, tMax, rec);
+}
+void rt::Rectangle::interaction(const ray& r, HitRecord& rec) const {
+	if (rec.primitive == 0) m_t1.interaction(r, rec);
+	else                    m_t2.interaction(r, rec);
 
-	return anyhit;
+	// update local position of the intersection
+	rec.lp = rec.p - m_position;
 }
 bool rt::Rectangle::boundingbox(aabb& box) const {
 	aabb box1, box2;
@@ -65,4 +80,11 @@ bool rt::Rectangle::boundingbox(aabb& box) const {
 	box = surrounding_box(box1, box2);
 
 	return true;
+}
+void rt::Rectangle::collect_lights(LightList& lights, const affine& transform, const IHitable* instance) const {
+	collect_lights(lights, transform, instance, this, 0);
+}
+void rt::Rectangle::collect_lights(LightList& lights, const affine& transform, const IHitable* instance, const IHitable* object, uint32_t primitive) const {
+	m_t1.collect_lights(lights, transform, instance, object, primitive);
+	m_t2.collect_lights(lights, transform, instance, object, primitive + 1);
 }
\ No newline at end of file
@@ -13,7 +13,21 @@ namespace rt {
 		Rectangle(vec3 p, vec3 right, vec3 up, std::shared_ptr<IMaterial> mat);
 
 		virtual bool hit(const ray& r, double tMin, double tMax, HitRecord& rec) const override;
+		virtual bool intersect(const ray& r, double tMin, double tMax, HitRecord& rec) const override;
+		virtual bool occluded(const ray& r, double tMin, double tMax) const override;
+		virtual void interaction(const ray& r, HitRecord& rec) const override;
 		virtual bool boundingbox(aabb& box) const override;
+		virtual void collect_lights(LightList& lights, const affine& transform, const IHitable* instance) const override;
+
+		/**
+		 * adds both triangles as lights if the material is emissive
+		 * @param lights - list the lights are added to
+		 * @param transform - transformation from the space of the rectangle to world space
+		 * @param instance - instance that contains the rectangle or nullptr
+		 * @param object - object that reports hits of the rectangle
+		 * @param primitive - primitive id of the first triangle, the second one uses primitive+1
+		 */
+		void collect_lights(LightList& lights, const affine& transform, const IHitable* instance, const IHitable* object, uint32_t primitive) const;
 
 	private:
 		vec3 m_position;
@@ -1,6 +1,18 @@
 #include "sphere.h"
 
+#include "light/lightlist.h"
+#include "light/spherelight.h"
+
 bool rt::Sphere::hit(const ray& r, double tmin, double tmax, HitRecord& rec) const {
+	if (intersect(r, tmin, tmax, rec)) {
+		interaction(r, rec);
+		return true;
+	}
+
+	return false;
+}
+
+bool rt::Sphere::intersect(const ray& r, double tmin, double tmax, HitRecord& rec) const {
 	// solve squared term
 	vec3 oc = r.o - center;
 	double a = dot(r.dir, r.dir);
@@ -27,23 +39,45 @@ bool rt::Sphere::hit(const ray& r, double tmin, double tmax, HitRecord& rec) con
 
 		// set hit record
 		rec.t = t;
-		rec.p = r.position(rec.t);
-		rec.normal = normalize(rec.p - center);
-		rec.material = material;
-		texture_coordinates(rec.normal, rec.u, rec.v);
-		rec.lp = rec.p - center;
+		rec.object = this;
+		rec.instance = nullptr;
+		rec.primitive = 0;
 
 		return true;
 	}
 
 	return false;
 };
+void rt::Sphere::interaction(const ray& r, HitRecord& rec) const {
+	rec.p = r.position(rec.t);
+	rec.normal = normalize(rec.p - center);
+	rec.material = material.get();
+	texture_coordinates(rec.normal, rec.u, rec.v);
+	rec.lp = rec.p - center;
+}
 
 bool rt::Sphere::boundingbox(aabb& box) const {
 	box = aabb(center - vec3(radius), center + vec3(radius));
 	return true;
 }
 
+void rt::Sphere::collect_lights(LightList& lights, const affine& transform, const IHitable* instance) const {
+	if (material == nullptr || !material->is_emissive()) return;
+
+	// the sphere stays a sphere only if all axes are scaled
+	// equally, otherwise it can't be sampled as sphere light
+	vec3 x = transform_vector(transform, vec3(1, 0, 0));
+	vec3 y = transform_vector(transform, vec3(0, 1, 0));
+	vec3 z = transform_vector(transform, vec3(0, 0, 1));
+	double scale = x.length();
+	double tolerance = 1e-6 * scale;
+	if (std::fabs(y.length() - scale) > tolerance || std::fabs(z.length() - scale) > tolerance) return;
+	if (std::fabs(dot(x, y)) > tolerance * scale || std::fabs(dot(y, z)) > tolerance * scale || std::fabs(dot(z, x)) > tolerance * scale) return;
+
+	vec3 c = transform_point(transform, center);
+	lights.add(std::make_shared<SphereLight>(c, radius * scale, instance, this), instance, this, 0);
+}
+
 void rt::Sphere::texture_coordinates(const vec3& p, float& u, float& v) const {
 	// cartesian to spherical coordinates
 	float r = rt::length(p);
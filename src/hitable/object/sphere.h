@@ -12,7 +12,10 @@ namespace rt {
 		Sphere(vec3 c, float r, std::shared_ptr<IMaterial> mat) : center(c), radius(r), material(mat) {};
     
 		virtual bool hit(const ray& r, double tMin, double tMax, HitRecord& rec) const;
+		virtual bool intersect(const ray& r, double tMin, double tMax, HitRecord& rec) const override;
+		virtual void interaction(const ray& r, HitRecord& rec) const override;
 		virtual bool boundingbox(aabb& box) const;
+		virtual void collect_lights(LightList& lights, const affine& transform, const IHitable* instance) const override;
 
 		vec3 center;
 		double radius;
@@ -1,6 +1,18 @@
 #include "triangle.h"
 
+#include "light/lightlist.h"
+#include "light/trianglelight.h"
+
 bool rt::Triangle::hit(const ray& r, double tmin, double tmax, HitRecord& rec) const {
+	if (intersect(r, tmin, tmax, rec)) {
+		interaction(r, rec);
+		return true;
+	}
+
+	return false;
+}
+
+bool rt::Triangle::intersect(const ray& r, double tmin, double tmax, HitRecord& rec) const {
 	// moeller-trumbore algorithm
 	vec3 v1 = p2 - p1;
 	vec3 v2 = p3 - p1;
@@ -28,22 +40,29 @@ bool rt::Triangle::hit(const ray& r, double tmin, double tmax, HitRecord& rec) c
 
 	if (t < tmin || t > tmax) return false;
 
-	// determine barycentric coordinates
-	vec3 p = r.position(t);
-	vec3 bcoords = barycentric(p, p1, p2, p3);
+	// the barycentric coordinates are a byproduct of the test
+	rec.t = t;
+	rec.object = this;
+	rec.instance = nullptr;
+	rec.primitive = 0;
+	rec.b1 = u;
+	rec.b2 = v;
+
+	return true;
+}
+void rt::Triangle::interaction(const ray& r, HitRecord& rec) const {
+	// interpolate the vertex attributes, the weights of p1, p2
+	// and p3 are (1-u-v), u and v
+	vec3 bcoords(1.0 - rec.b1 - rec.b2, rec.b1, rec.b2);
 	vec3 n = normalize(from_barycentric(bcoords, n1, n2, n3));
 	vec3 uvw = from_barycentric(bcoords, t1, t2, t3);
-	vec3 lp = (p1 + p2 + p3) / 3.f;
 
-	rec.t = t;
-	rec.p = p;
+	rec.p = r.position(rec.t);
 	rec.normal = n;
-	rec.u = uvw.x; 
+	rec.u = uvw.x;
 	rec.v = uvw.y;
-	rec.lp = lp;
-	rec.material = m_material;
-
-	return true;
+	rec.lp = rec.p;
+	rec.material = m_material.get();
 }
 bool rt::Triangle::boundingbox(aabb& box) const {
 	box = aabb();
@@ -54,15 +73,16 @@ bool rt::Triangle::boundingbox(aabb& box) const {
 	return true;
 }
 
-rt::vec3 rt::Triangle::barycentric(const vec3& x, const vec3& p1, const vec3& p2, const vec3& p3) const {
-	vec3 vn = cross(p2 - p1, p3 - p1);
-	float A = length(vn);
-	vec3 n = vn / A;
+void rt::Triangle::collect_lights(LightList& lights, const affine& transform, const IHitable* instance) const {
+	collect_lights(lights, transform, instance, this, 0);
+}
+void rt::Triangle::collect_lights(LightList& lights, const affine& transform, const IHitable* instance, const IHitable* object, uint32_t primitive) const {
+	if (m_material == nullptr || !m_material->is_emissive()) return;
 
-	float u = dot(cross(p3 - p2, x - p2), n) / A;
-	float v = dot(cross(x - p3, p3 - p1), n) / A;
-	float w = 1 - u - v;
-	return vec3(u, v, w);
+	vec3 a = transform_point(transform, p1);
+	vec3 b = transform_point(transform, p2);
+	vec3 c = transform_point(transform, p3);
+	lights.add(std::make_shared<TriangleLight>(a, b, c, instance, object, primitive), instance, object, primitive);
 }
 
 rt::vec3 rt::Triangle::from_barycentric(const vec3& b, const vec3& p1, const vec3& p2, const vec3& p3) const {
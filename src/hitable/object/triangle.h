@@ -19,7 +19,20 @@ namespace rt {
 			: p1(p1), p2(p2), p3(p3), n1(n1), n2(n2), n3(n3), t1(t1), t2(t2), t3(t3), m_material(mat) { };
 
 		virtual bool hit(const ray& r, double tMin, double tMax, HitRecord& rec) const override;
+		virtual bool intersect(const ray& r, double tMin, double tMax, HitRecord& rec) const override;
+		virtual void interaction(const ray& r, HitRecord& rec) const override;
 		virtual bool boundingbox(aabb& box) const override;
+		virtual void collect_lights(LightList& lights, const affine& transform, const IHitable* instance) const override;
+
+		/**
+		 * adds the triangle as light if its material is emissive
+		 * @param lights - list the lights are added to
+		 * @param transform - transformation from the space of the triangle to world space
+		 * @param instance - instance that contains the triangle or nullptr
+		 * @param object - object that reports hits of the triangle
+		 * @param primitive - primitive id that is reported by hits of the triangle
+		 */
+		void collect_lights(LightList& lights, const affine& transform, const IHitable* instance, const IHitable* object, uint32_t primitive) const;
 
 		vec3 p1, p2, p3;
 		vec3 n1, n2, n3;
@@ -28,17 +41,6 @@ namespace rt {
 	private:
 		std::shared_ptr<IMaterial> m_material;
 
-	/**
-	 * calculates the barycenteric coordinates of x relative to
-	 * the triangle defined by p1,p2,p3
-	 * @param x - point to determine barycentric coordinates for
-	 * @param p1 - first point of the triangle
-	 * @param p2 - second point of the triangle
-	 * @param p3 - third point of the triangle
-	 * @return barycentric coordinates of x
-	 */
-	 vec3 barycentric(const vec3& x, const vec3& p1, const vec3& p2, const vec3& p3) const;
-
 	 /**
 	  * calculates the position based on the barycentric coordinates
 	  * and the three vectors p1,p2,p3
@@ -1,5 +1,30 @@
 #include "bvh.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+#include "util/string.h"
+
+namespace {
+	// maximum number of hitables in a leaf
+	const size_t MAX_NODE_COUNT = std::numeric_limits<uint16_t>::max();
+	// maximum depth of the traversal stack
+	const size_t MAX_STACK_SIZE = 128;
+
+	// rounds down to the next float to keep the bounds conservative
+	float round_down(double v) {
+		float f = static_cast<float>(v);
+		return (static_cast<double>(f) > v) ? std::nextafter(f, -std::numeric_limits<float>::infinity()) : f;
+	}
+	// rounds up to the next float to keep the bounds conservative
+	float round_up(double v) {
+		float f = static_cast<float>(v);
+		return (static_cast<double>(f) < v) ? std::nextafter(f, std::numeric_limits<float>::infinity()) : f;
+	}
+}
+
 void rt::BVH::insert(std::shared_ptr<IHitable> hitable) {
 	m_hitables.push_back(hitable);
 }
@@ -8,104 +33,185 @@ void rt::BVH::insert_all(std::vector<std::shared_ptr<IHitable>> hitables) {
 }
 
 void rt::BVH::build() {
+	m_nodes.clear();
+	m_primitives.clear();
+	m_bounds = aabb();
+	m_statistics = { 0, 0, 0.0, 0.0 };
+
+	// start timer
+	auto starttime = std::chrono::high_resolution_clock::now();
+
+	// gather bounds and centroids once, hitables without
+	// bounds are empty and can't be hit anyways
+	std::vector<PrimitiveReference> references;
+	references.reserve(m_hitables.size());
+	for (size_t i = 0; i < m_hitables.size(); ++i) {
+		aabb box;
+		if (m_hitables[i]->boundingbox(box))
+			references.push_back({ box, box.center(), static_cast<uint32_t>(i) });
+	}
+
 	// do nothing when bvh is empty
-	if (m_hitables.size() == 0) return;
+	if (references.size() == 0) return;
+
+	// build the hierarchy and flatten it in depth first order
+	BVHBuilder builder(std::min(m_maxleafsize, MAX_NODE_COUNT), m_maxrecursiondepth, m_builder);
+	std::vector<BuildNode> nodes = builder.build(references);
+	m_bounds = nodes[0].bounds;
+	m_nodes = flatten(nodes);
+
+	// leaves reference the hitables in the order of the references
+	m_primitives.reserve(references.size());
+	for (auto& reference : references) {
+		m_primitives.push_back(m_hitables[reference.index].get());
+	}
 
-	m_root = create_node(m_hitables, 0);
+	// collect statistics
+	auto endtime = std::chrono::high_resolution_clock::now();
+	std::chrono::duration<double> elapsedtime = endtime - starttime;
+	m_statistics.primitives = m_primitives.size();
+	m_statistics.nodes = m_nodes.size();
+	m_statistics.buildtime = elapsedtime.count();
+	m_statistics.sahcost = builder.sah_cost(nodes);
 }
 
-std::shared_ptr<rt::BVH::Node> rt::BVH::create_node(std::vector<std::shared_ptr<IHitable>> hitables, size_t depth) {
-	// get surrounding bounding box
-	aabb surroundingbox;
-	for (auto h : hitables) {
-		aabb box;
-		if (h->boundingbox(box))
-			surroundingbox = surrounding_box(surroundingbox, box);
+void rt::BVH::print_statistics() const {
+	std::string type = (m_builder == PARALLEL_SAH_BUILDER) ? "parallel sah" : "sah";
+	console::println("BVH   : " + type + ", " + std::to_string(m_statistics.primitives) + " primitives, " + std::to_string(m_statistics.nodes) + " nodes");
+	console::println("BUILD : " + format_time(m_statistics.buildtime) + ", sah cost " + std::to_string(m_statistics.sahcost));
+}
+
+std::vector<rt::BVH::LinearNode> rt::BVH::flatten(const std::vector<BuildNode>& nodes) {
+	std::vector<LinearNode> linear;
+	linear.reserve(nodes.size());
+	if (!nodes.empty()) flatten(nodes, 0, linear);
+	return linear;
+}
+
+void rt::BVH::flatten(const std::vector<BuildNode>& nodes, uint32_t index, std::vector<LinearNode>& linear) {
+	const BuildNode& node = nodes[index];
+
+	// bounds are rounded outwards to stay conservative
+	LinearNode current;
+	for (size_t i = 0; i < 3; ++i) {
+		current.bmin[i] = round_down(node.bounds.min()[i]);
+		current.bmax[i] = round_up(node.bounds.max()[i]);
+	}
+	current.offset = 0;
+	current.count  = 0;
+	current.axis   = 0;
+	current.pad    = 0;
+	size_t position = linear.size();
+	linear.push_back(current);
+
+	// leaf node
+	if (node.leaf()) {
+		linear[position].offset = node.begin;
+		linear[position].count  = static_cast<uint16_t>(node.count);
+		return;
 	}
 
-	// create node
-	std::shared_ptr<BVH::Node> node = std::make_shared<BVH::Node>();
-	node->bounds = surroundingbox;
-	node->left = nullptr;
-	node->right = nullptr;
+	// the first child directly follows its parent
+	linear[position].axis = node.axis;
+	flatten(nodes, node.children[0], linear);
+	linear[position].offset = static_cast<uint32_t>(linear.size());
+	flatten(nodes, node.children[1], linear);
+}
 
-	// number of hitables is more than the number limit
-	if (hitables.size() <= m_maxleafsize || depth >= m_maxrecursiondepth) {
-		node->data = hitables;
+bool rt::BVH::hit(const ray& r, double tmin, double tmax, HitRecord& rec) const {
+	// the surface data is only computed for the closest hit
+	if (intersect(r, tmin, tmax, rec)) {
+		complete_interaction(r, rec);
+		return true;
 	}
-	else {
-		vec3 dim = surroundingbox.max() - surroundingbox.min();
-
-		// determine longest axis
-		vec3 dx(1, 0, 0); vec3 dy(0, 1, 0); vec3 dz(0, 0, 1);
-		vec3 axis = (dim.x > dim.y) ? ((dim.x > dim.z) ? dx : dz) : ((dim.y > dim.z) ? dy : dz);
-
-		// calculate center point along axis
-		double center = dot(surroundingbox.center(), axis);
-
-		// partition children based on the axis
-		std::vector<std::shared_ptr<IHitable>> leftdata;
-		std::vector<std::shared_ptr<IHitable>> rightdata;
-		for (auto& h : hitables) {
-			aabb box;
-			if (h->boundingbox(box)) {
-				double hcenter = dot(box.center(), axis);
-				if (hcenter < center) leftdata.push_back(h);
-				else                  rightdata.push_back(h);
+
+	return false;
+}
+
+bool rt::BVH::intersect(const ray& r, double tmin, double tmax, HitRecord& rec) const {
+	// bvh is empty
+	if (m_nodes.empty()) return false;
+
+	// precompute the ray data that is shared by all slab tests
+	double o[3], invdir[3];
+	bool negative[3];
+	for (size_t i = 0; i < 3; ++i) {
+		o[i] = r.o[i];
+		invdir[i] = 1.0 / r.dir[i];
+		negative[i] = invdir[i] < 0.0;
+	}
+
+	// the record is only written on a hit, thus tmax can shrink to the
+	// closest hit found so far and later hits are always closer
+	bool anyhit = false;
+	uint32_t stack[MAX_STACK_SIZE];
+	size_t stacksize = 0;
+	uint32_t current = 0;
+	while (true) {
+		const LinearNode& node = m_nodes[current];
+		if (hit_node(node, o, invdir, tmin, tmax)) {
+			if (node.count > 0) {
+				// leaf node
+				for (uint32_t i = node.offset; i < node.offset + node.count; ++i) {
+					if (m_primitives[i]->intersect(r, tmin, tmax, rec)) {
+						tmax = rec.t;
+						anyhit = true;
+					}
+				}
+			}
+			else {
+				// visit the child that is closer along the split axis first
+				if (negative[node.axis]) {
+					stack[stacksize++] = current + 1;
+					current = node.offset;
+				}
+				else {
+					stack[stacksize++] = node.offset;
+					current = current + 1;
+				}
+				continue;
 			}
 		}
 
-		// recursively create the hierarchy
-		size_t newdepth = depth + 1;
-		if (leftdata.size()  > 0) node->left  = create_node(leftdata,  newdepth);
-		if (rightdata.size() > 0) node->right = create_node(rightdata, newdepth);
+		if (stacksize == 0) break;
+		current = stack[--stacksize];
 	}
 
-	return node;
+	return anyhit;
 }
 
-bool rt::BVH::hit(const ray& r, double tmin, double tmax, HitRecord& rec) const {
-	return hit_node(r, m_root, tmin, tmax, rec);
-}
-bool rt::BVH::hit_node(const ray& r, const std::shared_ptr<Node> node, double tmin, double tmax, HitRecord& rec) const {
-	// node is empty
-	if (node == nullptr) return false;
-	
-	// only test children if ray intersects bounding box
-	if (node->bounds.hit(r, tmin, tmax)) {
-		bool anyhit = false;
-
-		// leaf node
-		if (node->left == nullptr && node->right == nullptr) {
-			// check all children and find closest hit
-			HitRecord temprec;
-			double mint = DBL_MAX;
-			for (auto h : node->data) {
-				if (h->hit(r, tmin, tmax, temprec) && temprec.t < mint) {
-					mint = temprec.t;
-					rec = temprec;
-					anyhit = true;
+bool rt::BVH::occluded(const ray& r, double tmin, double tmax) const {
+	// bvh is empty
+	if (m_nodes.empty()) return false;
+
+	double o[3], invdir[3];
+	for (size_t i = 0; i < 3; ++i) {
+		o[i] = r.o[i];
+		invdir[i] = 1.0 / r.dir[i];
+	}
+
+	// same traversal as intersect() but it stops at the first hit, thus
+	// the children don't have to be visited front to back
+	uint32_t stack[MAX_STACK_SIZE];
+	size_t stacksize = 0;
+	uint32_t current = 0;
+	while (true) {
+		const LinearNode& node = m_nodes[current];
+		if (hit_node(node, o, invdir, tmin, tmax)) {
+			if (node.count > 0) {
+				for (uint32_t i = node.offset; i < node.offset + node.count; ++i) {
+					if (m_primitives[i]->occluded(r, tmin, tmax)) return true;
 				}
 			}
-		}
-		else {
-			// collect hit record of left and right children
-			HitRecord recordleft, recordright;
-			recordleft.t  = DBL_MAX;
-			recordright.t = DBL_MAX;
-
-			// check children recursively
-			bool hitleft  = hit_node(r, node->left, tmin, tmax, recordleft);
-			bool hitright = hit_node(r, node->right, tmin, tmax, recordright);
-			anyhit = hitleft || hitright;
-
-			// get the record of the right closest child
-			if (hitleft && hitright)  rec = (recordleft.t < recordright.t) ? recordleft : recordright;
-			else if (hitleft)         rec = recordleft;
-			else if (hitright)        rec = recordright;
+			else {
+				stack[stacksize++] = node.offset;
+				current = current + 1;
+				continue;
+			}
 		}
 
-		return anyhit;
+		if (stacksize == 0) break;
+		current = stack[--stacksize];
 	}
 
 	return false;
@@ -113,9 +219,15 @@ bool rt::BVH::hit_node(const ray& r, const std::shared_ptr<Node> node, double tm
 
 bool rt::BVH::boundingbox(aabb& box) const {
 	// early return if box hasn't been initialized
-	if (m_root == nullptr) return false;
+	if (m_nodes.empty()) return false;
 
 	// get bounds of the root node
-	box = m_root->bounds;
+	box = m_bounds;
 	return true;
+}
+
+void rt::BVH::collect_lights(LightList& lights, const affine& transform, const IHitable* instance) const {
+	for (auto& hitable : m_hitables) {
+		hitable->collect_lights(lights, transform, instance);
+	}
 }
\ No newline at end of file
@@ -1,38 +1,109 @@
 #ifndef BVH_H
 #define BVH_H
 
+#include <algorithm>
+#include <cstdint>
 #include <vector>
 
 #include "iorganization.h"
 #include "io/console.h"
+#include "spatial/bvhbuilder.h"
 
 namespace rt {
 class BVH : public IOrganization {
 public:
-	struct Node {
-		std::shared_ptr<Node> left;
-		std::shared_ptr<Node> right;
-		std::vector<std::shared_ptr<IHitable>> data;
-		aabb bounds;
+	/**
+	 * node of the flattened hierarchy. the first child of an interior node
+	 * directly follows its parent in the node array, while the index of the
+	 * second child is stored in offset. leaves store the range of their
+	 * hitables in [offset, offset+count)
+	 */
+	struct LinearNode {
+		float    bmin[3];
+		float    bmax[3];
+		uint32_t offset;
+		uint16_t count;
+		uint8_t  axis;
+		uint8_t  pad;
 	};
+	static_assert(sizeof(LinearNode) == 32, "linear bvh nodes have to be 32 bytes");
 
-	BVH(size_t maxleafsize = 10, size_t maxrecursiondepth = 50) 
-		: m_maxleafsize(maxleafsize), m_maxrecursiondepth(maxrecursiondepth) { }
+	/**
+	 * statistics of the last build
+	 */
+	struct BuildStatistics {
+		size_t primitives;
+		size_t nodes;
+		double buildtime;
+		double sahcost;
+	};
+
+	BVH(size_t maxleafsize = 10, size_t maxrecursiondepth = 50, BuilderType builder = SAH_BUILDER)
+		: m_maxleafsize(maxleafsize), m_maxrecursiondepth(maxrecursiondepth), m_builder(builder), m_statistics{ 0, 0, 0.0, 0.0 } { }
 
 	void insert(std::shared_ptr<IHitable> hitable) override;
 	void insert_all(std::vector<std::shared_ptr<IHitable>> hitables) override;
 	void build() override;
 
+	/**
+	 * sets the algorithm used by the next build
+	 * @param builder - serial or parallel construction
+	 */
+	void set_builder(BuilderType builder) { m_builder = builder; }
+	/**
+	 * returns the statistics of the last build
+	 * @return number of nodes, build time in seconds and sah cost
+	 */
+	const BuildStatistics& statistics() const { return m_statistics; }
+	/**
+	 * prints the statistics of the last build to the console
+	 */
+	void print_statistics() const;
+
+	/**
+	 * flattens a hierarchy created by the builder in depth first order
+	 * @param nodes - nodes of the hierarchy, the root is the first node
+	 * @return linear nodes with bounds rounded outwards to float
+	 */
+	static std::vector<LinearNode> flatten(const std::vector<BuildNode>& nodes);
+	/**
+	 * slab test of a ray against the bounds of a linear node
+	 * @param node - node to test
+	 * @param o - origin of the ray
+	 * @param invdir - inverse direction of the ray
+	 * @param tmin - start of the ray interval
+	 * @param tmax - end of the ray interval
+	 * @return true if the ray interval overlaps the bounds
+	 */
+	static bool hit_node(const LinearNode& node, const double o[3], const double invdir[3], double tmin, double tmax) {
+		for (size_t i = 0; i < 3; ++i) {
+			double t0 = (node.bmin[i] - o[i]) * invdir[i];
+			double t1 = (node.bmax[i] - o[i]) * invdir[i];
+			if (invdir[i] < 0.0) std::swap(t0, t1);
+
+			tmin = std::max(tmin, t0);
+			tmax = std::min(tmax, t1);
+			if (tmax < tmin) return false;
+		}
+		return true;
+	}
+
 	virtual bool hit(const ray& r, double tMin, double tMax, HitRecord& rec) const override;
+	virtual bool intersect(const ray& r, double tMin, double tMax, HitRecord& rec) const override;
+	virtual bool occluded(const ray& r, double tMin, double tMax) const override;
 	virtual bool boundingbox(aabb& box) const override;
+	virtual void collect_lights(LightList& lights, const affine& transform, const IHitable* instance) const override;
 
 private:
 	size_t m_maxleafsize, m_maxrecursiondepth;
-	std::shared_ptr<Node> m_root;
+	BuilderType m_builder;
+	BuildStatistics m_statistics;
 	std::vector<std::shared_ptr<IHitable>> m_hitables;
+	std::vector<LinearNode> m_nodes;
+	std::vector<const IHitable*> m_primitives;
+	aabb m_bounds;
 
-	std::shared_ptr<Node> create_node(std::vector<std::shared_ptr<IHitable>> hitables, size_t depth);
-	bool hit_node(const ray& r, const std::shared_ptr<Node> node, double tMin, double tMax, HitRecord& rec) const;
+	static void flatten(const std::vector<BuildNode>& nodes, uint32_t index, std::vector<LinearNode>& linear);
 };
 }
 
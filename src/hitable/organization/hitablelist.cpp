@@ -1,21 +1,38 @@
 #include "hitablelist.h"
 
 bool rt::HitableList::hit(const ray& r, double tmin, double tmax, HitRecord& rec) const {
-	HitRecord tempRec;
+	// the surface data is only computed for the closest hit
+	if (intersect(r, tmin, tmax, rec)) {
+		complete_interaction(r, rec);
+		return true;
+	}
+
+	return false;
+}
 
+bool rt::HitableList::intersect(const ray& r, double tmin, double tmax, HitRecord& rec) const {
+	// hitables only write the record on a hit, thus it can
+	// be passed directly while the interval shrinks
 	bool hitAnything = false;
 	double closestSoFar = tmax;
 	for (size_t i = 0; i < m_list.size(); i++) {
-		if (m_list.at(i)->hit(r, tmin, closestSoFar, tempRec)) {
+		if (m_list[i]->intersect(r, tmin, closestSoFar, rec)) {
 			hitAnything = true;
-			closestSoFar = tempRec.t;
-			rec = tempRec;
+			closestSoFar = rec.t;
 		}
 	}
 
 	return hitAnything;
 }
 
+bool rt::HitableList::occluded(const ray& r, double tmin, double tmax) const {
+	for (size_t i = 0; i < m_list.size(); i++) {
+		if (m_list[i]->occluded(r, tmin, tmax)) return true;
+	}
+
+	return false;
+}
+
 bool rt::HitableList::boundingbox(aabb& box) const {
 	// hitable list has no children  and thus no bounding box
 	if (m_list.size() < 1) return false;
@@ -34,4 +51,10 @@ bool rt::HitableList::boundingbox(aabb& box) const {
 	}
 
 	return true;
+}
+
+void rt::HitableList::collect_lights(LightList& lights, const affine& transform, const IHitable* instance) const {
+	for (auto& hitable : m_list) {
+		hitable->collect_lights(lights, transform, instance);
+	}
 }
\ No newline at end of file
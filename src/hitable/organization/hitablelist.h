@@ -15,7 +15,10 @@ public:
 	void build() override { };
 
     virtual bool hit(const ray& r, double tMin, double tMax, HitRecord& rec) const;
+	virtual bool intersect(const ray& r, double tMin, double tMax, HitRecord& rec) const override;
+	virtual bool occluded(const ray& r, double tMin, double tMax) const override;
 	virtual bool boundingbox(aabb& box) const;
+	virtual void collect_lights(LightList& lights, const affine& transform, const IHitable* instance) const override;
 
 private:
     std::vector<std::shared_ptr<IHitable>> m_list;
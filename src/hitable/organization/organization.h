@@ -4,5 +4,6 @@
 #include "bvh.h"
 #include "hitablelist.h"
 #include "iorganization.h"
+#include "widebvh.h"
 
 #endif//ORGANIZATION_H
\ No newline at end of file
@@ -0,0 +1,367 @@
+#include "widebvh.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RT_SSE
+#include <immintrin.h>
+#endif
+#if defined(__AVX__)
+#define RT_AVX
+#endif
+
+#include "util/string.h"
+
+namespace {
+	// maximum number of hitables in a leaf
+	const size_t MAX_LEAF_COUNT = std::numeric_limits<uint16_t>::max();
+	// marks unused child slots
+	const uint32_t EMPTY_CHILD = std::numeric_limits<uint32_t>::max();
+	// widens the far distance of the float box tests to account for rounding errors
+	const float ROBUST_SCALE = 1.0f + 2.0f * 3.0f * std::numeric_limits<float>::epsilon();
+
+	/**
+	 * ray data shared by all box tests of a traversal
+	 */
+	struct RayData {
+		float o[3];
+		float invdir[3];
+		bool negative[3];
+	};
+
+	/**
+	 * entry of the traversal stack, either a node or a leaf
+	 */
+	struct StackEntry {
+		uint32_t child;
+		uint32_t count;
+		float t;
+	};
+
+	float round_down(double v) {
+		float f = static_cast<float>(v);
+		return (static_cast<double>(f) > v) ? std::nextafter(f, -std::numeric_limits<float>::infinity()) : f;
+	}
+	float round_up(double v) {
+		float f = static_cast<float>(v);
+		return (static_cast<double>(f) < v) ? std::nextafter(f, std::numeric_limits<float>::infinity()) : f;
+	}
+	float to_float(double v) {
+		if (v >=  std::numeric_limits<float>::max()) return  std::numeric_limits<float>::infinity();
+		if (v <= -std::numeric_limits<float>::max()) return -std::numeric_limits<float>::infinity();
+		return static_cast<float>(v);
+	}
+
+	/**
+	 * tests the ray against the boxes of all children of a node
+	 * @return bit mask of the hit children, the entry distances are written to tnear
+	 */
+	template <size_t N>
+	uint32_t intersect_children(const typename rt::WideBVH<N>::WideNode& node, const RayData& ray, float tmin, float tmax, float* tnear) {
+		const float* bnear[3];
+		const float* bfar[3];
+		for (size_t a = 0; a < 3; ++a) {
+			bnear[a] = ray.negative[a] ? node.bmax[a] : node.bmin[a];
+			bfar[a]  = ray.negative[a] ? node.bmin[a] : node.bmax[a];
+		}
+
+		// the running interval is the second operand of min and max, thus
+		// nan values caused by flat boxes leave the interval untouched
+#if defined(RT_AVX)
+		if constexpr (N == 8) {
+			__m256 tn = _mm256_set1_ps(tmin);
+			__m256 tf = _mm256_set1_ps(tmax);
+			for (size_t a = 0; a < 3; ++a) {
+				__m256 o = _mm256_set1_ps(ray.o[a]);
+				__m256 invdir = _mm256_set1_ps(ray.invdir[a]);
+				tn = _mm256_max_ps(_mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(bnear[a]), o), invdir), tn);
+				tf = _mm256_min_ps(_mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(bfar[a]),  o), invdir), tf);
+			}
+			tf = _mm256_mul_ps(tf, _mm256_set1_ps(ROBUST_SCALE));
+			_mm256_storeu_ps(tnear, tn);
+			return static_cast<uint32_t>(_mm256_movemask_ps(_mm256_cmp_ps(tn, tf, _CMP_LE_OQ)));
+		}
+#endif
+#if defined(RT_SSE)
+		uint32_t mask = 0;
+		for (size_t g = 0; g < N; g += 4) {
+			__m128 tn = _mm_set1_ps(tmin);
+			__m128 tf = _mm_set1_ps(tmax);
+			for (size_t a = 0; a < 3; ++a) {
+				__m128 o = _mm_set1_ps(ray.o[a]);
+				__m128 invdir = _mm_set1_ps(ray.invdir[a]);
+				tn = _mm_max_ps(_mm_mul_ps(_mm_sub_ps(_mm_load_ps(bnear[a] + g), o), invdir), tn);
+				tf = _mm_min_ps(_mm_mul_ps(_mm_sub_ps(_mm_load_ps(bfar[a] + g),  o), invdir), tf);
+			}
+			tf = _mm_mul_ps(tf, _mm_set1_ps(ROBUST_SCALE));
+			_mm_storeu_ps(tnear + g, tn);
+			mask |= static_cast<uint32_t>(_mm_movemask_ps(_mm_cmple_ps(tn, tf))) << g;
+		}
+		return mask;
+#else
+		uint32_t mask = 0;
+		for (size_t i = 0; i < N; ++i) {
+			float tn = tmin, tf = tmax;
+			for (size_t a = 0; a < 3; ++a) {
+				float t0 = (bnear[a][i] - ray.o[a]) * ray.invdir[a];
+				float t1 = (bfar[a][i]  - ray.o[a]) * ray.invdir[a];
+				tn = (t0 > tn) ? t0 : tn;
+				tf = (t1 < tf) ? t1 : tf;
+			}
+			tnear[i] = tn;
+			if (tn <= tf * ROBUST_SCALE) mask |= 1u << i;
+		}
+		return mask;
+#endif
+	}
+}
+
+template <size_t N>
+void rt::WideBVH<N>::insert(std::shared_ptr<IHitable> hitable) {
+	m_hitables.push_back(hitable);
+}
+template <size_t N>
+void rt::WideBVH<N>::insert_all(std::vector<std::shared_ptr<IHitable>> hitables) {
+	m_hitables.insert(m_hitables.end(), hitables.begin(), hitables.end());
+}
+
+template <size_t N>
+void rt::WideBVH<N>::build() {
+	m_nodes.clear();
+	m_primitives.clear();
+	m_bounds = aabb();
+	m_statistics = { 0, 0, 0.0, 0.0 };
+
+	// start timer
+	auto starttime = std::chrono::high_resolution_clock::now();
+
+	// gather bounds and centroids once, hitables without
+	// bounds are empty and can't be hit anyways
+	std::vector<PrimitiveReference> references;
+	references.reserve(m_hitables.size());
+	for (size_t i = 0; i < m_hitables.size(); ++i) {
+		aabb box;
+		if (m_hitables[i]->boundingbox(box))
+			references.push_back({ box, box.center(), static_cast<uint32_t>(i) });
+	}
+
+	// do nothing when bvh is empty
+	if (references.size() == 0) return;
+
+	// build a binary hierarchy and collapse it into wide nodes
+	BVHBuilder builder(std::min(m_maxleafsize, MAX_LEAF_COUNT), m_maxrecursiondepth, m_builder);
+	std::vector<BuildNode> nodes = builder.build(references);
+	m_bounds = nodes[0].bounds;
+	uint32_t root = 0;
+	if (nodes[0].leaf()) collapse(nodes, &root, 1);
+	else                 collapse(nodes, nodes[0].children, 2);
+
+	// leaves reference the hitables in the order of the references
+	m_primitives.reserve(references.size());
+	for (auto& reference : references) {
+		m_primitives.push_back(m_hitables[reference.index].get());
+	}
+
+	// collect statistics
+	auto endtime = std::chrono::high_resolution_clock::now();
+	std::chrono::duration<double> elapsedtime = endtime - starttime;
+	m_statistics.primitives = m_primitives.size();
+	m_statistics.nodes = m_nodes.size();
+	m_statistics.buildtime = elapsedtime.count();
+	m_statistics.sahcost = builder.sah_cost(nodes);
+}
+
+template <size_t N>
+uint32_t rt::WideBVH<N>::collapse(const std::vector<BuildNode>& nodes, const uint32_t* children, size_t count) {
+	// pull up the children of the biggest interior child until the node is full
+	uint32_t slots[N];
+	std::copy(children, children + count, slots);
+	while (count < N) {
+		size_t best = count;
+		double bestarea = -1.0;
+		for (size_t i = 0; i < count; ++i) {
+			const BuildNode& node = nodes[slots[i]];
+			double area = node.bounds.surface_area();
+			if (!node.leaf() && area > bestarea) {
+				best = i;
+				bestarea = area;
+			}
+		}
+		if (best == count) break;
+
+		const BuildNode& node = nodes[slots[best]];
+		slots[best] = node.children[0];
+		slots[count++] = node.children[1];
+	}
+
+	// create node with empty slots
+	uint32_t index = static_cast<uint32_t>(m_nodes.size());
+	m_nodes.emplace_back();
+	for (size_t i = 0; i < N; ++i) {
+		for (size_t a = 0; a < 3; ++a) {
+			m_nodes[index].bmin[a][i] =  std::numeric_limits<float>::infinity();
+			m_nodes[index].bmax[a][i] = -std::numeric_limits<float>::infinity();
+		}
+		m_nodes[index].children[i] = EMPTY_CHILD;
+		m_nodes[index].counts[i] = 0;
+	}
+
+	// fill the slots, the node array might get
+	// reallocated thus the node is accessed by index
+	for (size_t i = 0; i < count; ++i) {
+		const BuildNode& node = nodes[slots[i]];
+		uint32_t child = (node.leaf()) ? node.begin : collapse(nodes, node.children, 2);
+		for (size_t a = 0; a < 3; ++a) {
+			m_nodes[index].bmin[a][i] = round_down(node.bounds.min()[a]);
+			m_nodes[index].bmax[a][i] = round_up(node.bounds.max()[a]);
+		}
+		m_nodes[index].children[i] = child;
+		m_nodes[index].counts[i] = static_cast<uint16_t>(node.count);
+	}
+
+	return index;
+}
+
+template <size_t N>
+void rt::WideBVH<N>::print_statistics() const {
+	std::string type = (m_builder == PARALLEL_SAH_BUILDER) ? "parallel sah" : "sah";
+	console::println("BVH" + std::to_string(N) + "  : " + type + ", " + std::to_string(m_statistics.primitives) + " primitives, " + std::to_string(m_statistics.nodes) + " nodes");
+	console::println("BUILD : " + format_time(m_statistics.buildtime) + ", sah cost " + std::to_string(m_statistics.sahcost));
+}
+
+template <size_t N>
+bool rt::WideBVH<N>::hit(const ray& r, double tmin, double tmax, HitRecord& rec) const {
+	// the surface data is only computed for the closest hit
+	if (intersect(r, tmin, tmax, rec)) {
+		complete_interaction(r, rec);
+		return true;
+	}
+
+	return false;
+}
+
+template <size_t N>
+bool rt::WideBVH<N>::intersect(const ray& r, double tmin, double tmax, HitRecord& rec) const {
+	// bvh is empty
+	if (m_nodes.empty()) return false;
+
+	// precompute the ray data that is shared by all box tests
+	RayData raydata;
+	for (size_t i = 0; i < 3; ++i) {
+		raydata.o[i] = static_cast<float>(r.o[i]);
+		raydata.invdir[i] = 1.0f / static_cast<float>(r.dir[i]);
+		raydata.negative[i] = raydata.invdir[i] < 0.0f;
+	}
+
+	// each node pushes at most N-1 entries more than it pops
+	StackEntry stack[128 * (N - 1)];
+	size_t stacksize = 0;
+	stack[stacksize++] = { 0, 0, to_float(tmin) };
+
+	// the record is only written on a hit, thus tmax can shrink to the
+	// closest hit found so far and later hits are always closer
+	bool anyhit = false;
+	float ftmin = to_float(tmin);
+	float ftmax = to_float(tmax);
+	while (stacksize > 0) {
+		StackEntry entry = stack[--stacksize];
+		if (entry.t > ftmax * ROBUST_SCALE) continue;
+
+		// leaf node
+		if (entry.count > 0) {
+			for (uint32_t i = entry.child; i < entry.child + entry.count; ++i) {
+				if (m_primitives[i]->intersect(r, tmin, tmax, rec)) {
+					tmax = rec.t;
+					ftmax = to_float(tmax);
+					anyhit = true;
+				}
+			}
+			continue;
+		}
+
+		// test all children at once
+		const WideNode& node = m_nodes[entry.child];
+		alignas(32) float tnear[N];
+		uint32_t mask = intersect_children<N>(node, raydata, ftmin, ftmax, tnear);
+		if (mask == 0) continue;
+
+		// push the hit children from far to near so the nearest is visited first
+		size_t first = stacksize;
+		for (size_t i = 0; i < N; ++i) {
+			if ((mask & (1u << i)) == 0) continue;
+			StackEntry child = { node.children[i], node.counts[i], tnear[i] };
+			size_t j = stacksize++;
+			while (j > first && stack[j - 1].t < child.t) {
+				stack[j] = stack[j - 1];
+				--j;
+			}
+			stack[j] = child;
+		}
+	}
+
+	return anyhit;
+}
+
+template <size_t N>
+bool rt::WideBVH<N>::occluded(const ray& r, double tmin, double tmax) const {
+	// bvh is empty
+	if (m_nodes.empty()) return false;
+
+	RayData raydata;
+	for (size_t i = 0; i < 3; ++i) {
+		raydata.o[i] = static_cast<float>(r.o[i]);
+		raydata.invdir[i] = 1.0f / static_cast<float>(r.dir[i]);
+		raydata.negative[i] = raydata.invdir[i] < 0.0f;
+	}
+
+	// the children don't have to be sorted since any hit ends the traversal
+	StackEntry stack[128 * (N - 1)];
+	size_t stacksize = 0;
+	stack[stacksize++] = { 0, 0, to_float(tmin) };
+
+	float ftmin = to_float(tmin);
+	float ftmax = to_float(tmax);
+	while (stacksize > 0) {
+		StackEntry entry = stack[--stacksize];
+
+		// leaf node
+		if (entry.count > 0) {
+			for (uint32_t i = entry.child; i < entry.child + entry.count; ++i) {
+				if (m_primitives[i]->occluded(r, tmin, tmax)) return true;
+			}
+			continue;
+		}
+
+		const WideNode& node = m_nodes[entry.child];
+		alignas(32) float tnear[N];
+		uint32_t mask = intersect_children<N>(node, raydata, ftmin, ftmax, tnear);
+		for (size_t i = 0; i < N; ++i) {
+			if (mask & (1u << i)) stack[stacksize++] = { node.children[i], node.counts[i], tnear[i] };
+		}
+	}
+
+	return false;
+}
+
+template <size_t N>
+bool rt::WideBVH<N>::boundingbox(aabb& box) const {
+	// early return if box hasn't been initialized
+	if (m_nodes.empty()) return false;
+
+	// get bounds of the root node
+	box = m_bounds;
+	return true;
+}
+
+template <size_t N>
+void rt::WideBVH<N>::collect_lights(LightList& lights, const affine& transform, const IHitable* instance) const {
+	for (auto& hitable : m_hitables) {
+		hitable->collect_lights(lights, transform, instance);
+	}
+}
+
+template class rt::WideBVH<4>;
+template class rt::WideBVH<8>;
\ No newline at end of file
@@ -0,0 +1,77 @@
+#ifndef WIDE_BVH_H
+#define WIDE_BVH_H
+
+#include <cstdint>
+#include <vector>
+
+#include "bvh.h"
+#include "iorganization.h"
+#include "spatial/bvhbuilder.h"
+
+namespace rt {
+/**
+ * bounding volume hierarchy with N children per node. it is created by
+ * collapsing a binary sah hierarchy and tests the ray against the boxes of
+ * all children at once using sse or avx instructions
+ */
+template <size_t N>
+class WideBVH : public IOrganization {
+public:
+	/**
+	 * node storing the bounds of its children as structure of arrays.
+	 * interior children store the index of their node in children, leaf
+	 * children store the range of their hitables in [children, children+counts).
+	 * unused slots have an empty box that can't be hit
+	 */
+	struct alignas(64) WideNode {
+		float    bmin[3][N];
+		float    bmax[3][N];
+		uint32_t children[N];
+		uint16_t counts[N];
+	};
+
+	WideBVH(size_t maxleafsize = 10, size_t maxrecursiondepth = 50, BuilderType builder = SAH_BUILDER)
+		: m_maxleafsize(maxleafsize), m_maxrecursiondepth(maxrecursiondepth), m_builder(builder), m_statistics{ 0, 0, 0.0, 0.0 } { }
+
+	void insert(std::shared_ptr<IHitable> hitable) override;
+	void insert_all(std::vector<std::shared_ptr<IHitable>> hitables) override;
+	void build() override;
+
+	/**
+	 * sets the algorithm used by the next build of the binary hierarchy
+	 * @param builder - serial or parallel construction
+	 */
+	void set_builder(BuilderType builder) { m_builder = builder; }
+	/**
+	 * returns the statistics of the last build
+	 * @return number of wide nodes, build time in seconds and sah cost of the binary hierarchy
+	 */
+	const BVH::BuildStatistics& statistics() const { return m_statistics; }
+	/**
+	 * prints the statistics of the last build to the console
+	 */
+	void print_statistics() const;
+
+	virtual bool hit(const ray& r, double tMin, double tMax, HitRecord& rec) const override;
+	virtual bool intersect(const ray& r, double tMin, double tMax, HitRecord& rec) const override;
+	virtual bool occluded(const ray& r, double tMin, double tMax) const override;
+	virtual bool boundingbox(aabb& box) const override;
+	virtual void collect_lights(LightList& lights, const affine& transform, const IHitable* instance) const override;
+
+private:
+	size_t m_maxleafsize, m_maxrecursiondepth;
+	BuilderType m_builder;
+	BVH::BuildStatistics m_statistics;
+	std::vector<std::shared_ptr<IHitable>> m_hitables;
+	std::vector<WideNode> m_nodes;
+	std::vector<const IHitable*> m_primitives;
+	aabb m_bounds;
+
+	uint32_t collapse(const std::vector<BuildNode>& nodes, const uint32_t* children, size_t count);
+};
+
+using BVH4 = WideBVH<4>;
+using BVH8 = WideBVH<8>;
+}
+
+#endif//WIDE_BVH_H
\ No newline at end of file
@@ -1,24 +1,17 @@
 #ifndef ROTATION_H
 #define ROTATION_H
 
-#include "hitable/ihitable.h"
+#include "transform.h"
 
 namespace rt {
-	class Rotation : public IHitable {
+	/**
+	 * counter-clockwise rotation of a hitable around an axis. the rotation
+	 * matrix is computed once instead of rotating on every hit
+	 */
+	class Rotation : public Transform {
 	public:
-		Rotation(std::shared_ptr<IHitable> hitable, const vec3& axis, float angle);
-
-		virtual bool hit(const ray& r, double tMin, double tMax, HitRecord& rec) const override;
-		virtual bool boundingbox(aabb& box) const override;
-
-	private:
-		std::shared_ptr<IHitable> m_hitable;
-		vec3 m_axis;
-		float m_theta;
-		aabb m_bounds;
-		bool m_hasbounds;
-
-		vec3 rotate(const vec3& v, float theta) const;
+		Rotation(std::shared_ptr<IHitable> hitable, const vec3& axis, float angle)
+			: Transform(hitable, affine::rotation(axis, angle)) { }
 	};
 }
 
@@ -1,9 +1,16 @@
 #ifndef SCALE_H
 #define SCALE_H
 
-namespace rt {
-	class Scale {
+#include "transform.h"
 
+namespace rt {
+	/**
+	 * scales a hitable along the coordinate axes
+	 */
+	class Scale : public Transform {
+	public:
+		Scale(std::shared_ptr<IHitable> hitable, const vec3& factors)
+			: Transform(hitable, affine::scaling(factors)) { }
 	};
 }
 
@@ -0,0 +1,69 @@
+#include "transform.h"
+
+rt::Transform::Transform(std::shared_ptr<IHitable> hitable, const affine& transform)
+	: m_hitable(hitable), m_transform(transform) {
+	// fold nested transformations into one instead of chaining them
+	auto inner = std::dynamic_pointer_cast<Transform>(hitable);
+	if (inner != nullptr) {
+		m_hitable = inner->m_hitable;
+		m_transform = transform * inner->m_transform;
+	}
+	m_inverse = inverse(m_transform);
+
+	// bake the bounds in world space
+	aabb bounds;
+	m_hasbounds = m_hitable->boundingbox(bounds);
+	if (m_hasbounds) m_bounds = transform_box(m_transform, bounds);
+}
+
+bool rt::Transform::hit(const ray& r, double tmin, double tmax, HitRecord& record) const {
+	if (intersect(r, tmin, tmax, record)) {
+		interaction(r, record);
+		return true;
+	}
+
+	return false;
+}
+bool rt::Transform::intersect(const ray& r, double tmin, double tmax, HitRecord& record) const {
+	// transform ray into local space, the direction isn't
+	// normalized again thus t is the same in both spaces
+	ray localray(transform_point(m_inverse, r.o), transform_vector(m_inverse, r.dir));
+	if (!m_hitable->intersect(localray, tmin, tmax, record)) return false;
+
+	// only one instance per hit is deferred, nested ones are completed right away
+	if (record.instance != nullptr) {
+		record.instance->interaction(localray, record);
+		record.object = nullptr;
+	}
+	record.instance = this;
+	return true;
+}
+bool rt::Transform::occluded(const ray& r, double tmin, double tmax) const {
+	ray localray(transform_point(m_inverse, r.o), transform_vector(m_inverse, r.dir));
+	return m_hitable->occluded(localray, tmin, tmax);
+}
+void rt::Transform::interaction(const ray& r, HitRecord& record) const {
+	// complete the hit in local space
+	ray localray(transform_point(m_inverse, r.o), transform_vector(m_inverse, r.dir));
+	if (record.object != nullptr) record.object->interaction(localray, record);
+
+	// transform intersection and normal back, the local
+	// point stays in the space of the hitable
+	record.p = transform_point(m_transform, record.p);
+	record.normal = normalize(transform_normal(m_inverse, record.normal));
+}
+bool rt::Transform::boundingbox(aabb& box) const {
+	if (m_hasbounds) {
+		box = m_bounds;
+		return true;
+	}
+
+	return false;
+}
+void rt::Transform::collect_lights(LightList& lights, const affine& transform, const IHitable* instance) const {
+	// hits inside of nested instances are completed right away and can't
+	// be traced back to their object, thus their lights aren't sampled
+	if (instance != nullptr) return;
+
+	m_hitable->collect_lights(lights, transform * m_transform, this);
+}
\ No newline at end of file
@@ -0,0 +1,40 @@
+#ifndef TRANSFORM_H
+#define TRANSFORM_H
+
+#include "hitable/ihitable.h"
+#include "math/affine.h"
+
+namespace rt {
+	/**
+	 * instance of a hitable that is placed in the scene by an affine transformation.
+	 * the hitable itself stays in its local space and can be shared by many
+	 * instances, while the ray gets transformed into that space once per hit test
+	 */
+	class Transform : public IHitable {
+	public:
+		/**
+		 * @param hitable - hitable in local space
+		 * @param transform - transformation from local to world space
+		 */
+		Transform(std::shared_ptr<IHitable> hitable, const affine& transform);
+
+		virtual bool hit(const ray& r, double tMin, double tMax, HitRecord& rec) const override;
+		virtual bool intersect(const ray& r, double tMin, double tMax, HitRecord& rec) const override;
+		virtual bool occluded(const ray& r, double tMin, double tMax) const override;
+		virtual void interaction(const ray& r, HitRecord& rec) const override;
+		virtual bool boundingbox(aabb& box) const override;
+		virtual void collect_lights(LightList& lights, const affine& transform, const IHitable* instance) const override;
+
+		const affine& transform() const { return m_transform; }
+		std::shared_ptr<IHitable> hitable() const { return m_hitable; }
+
+	private:
+		std::shared_ptr<IHitable> m_hitable;
+		affine m_transform;
+		affine m_inverse;
+		aabb m_bounds;
+		bool m_hasbounds;
+	};
+}
+
+#endif//TRANSFORM_H
\ No newline at end of file
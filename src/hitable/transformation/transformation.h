@@ -3,6 +3,7 @@
 
 #include "rotation.h"
 #include "scale.h"
+#include "transform.h"
 #include "translation.h"
 
 #endif//TRANSFORMATION_H
\ No newline at end of file
@@ -1,19 +1,16 @@
 #ifndef TRANSLATION_H
 #define TRANSLATION_H
 
-#include "hitable/ihitable.h"
+#include "transform.h"
 
 namespace rt {
-	class Translation : public IHitable {
+	/**
+	 * moves a hitable by an offset
+	 */
+	class Translation : public Transform {
 	public:
-		Translation(std::shared_ptr<IHitable> hitable, const vec3& offset);
-
-		virtual bool hit(const ray& r, double tMin, double tMax, HitRecord& rec) const override;
-		virtual bool boundingbox(aabb& box) const override;
-
-	private:
-		std::shared_ptr<IHitable> m_hitable;
-		vec3 m_offset;
+		Translation(std::shared_ptr<IHitable> hitable, const vec3& offset)
+			: Transform(hitable, affine::translation(offset)) { }
 	};
 }
 
@@ -0,0 +1,59 @@
+#ifndef BINARY_H
+#define BINARY_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <string>
+#include <vector>
+
+namespace rt {
+	/**
+	 * returns whether the host stores the least significant byte first
+	 * @return true for little endian hosts
+	 */
+	inline bool is_little_endian() {
+		const uint16_t probe = 1;
+		return *reinterpret_cast<const unsigned char*>(&probe) == 1;
+	}
+
+	/**
+	 * appends a value in little endian byte order regardless of the host
+	 * @param buffer - buffer to append to
+	 * @param value - integer or floating point value
+	 */
+	template <typename T>
+	void put(std::vector<char>& buffer, T value) {
+		char bytes[sizeof(T)];
+		std::memcpy(bytes, &value, sizeof(T));
+		if (!is_little_endian()) std::reverse(bytes, bytes + sizeof(T));
+
+		buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+	}
+	/**
+	 * appends a null terminated string
+	 * @param buffer - buffer to append to
+	 * @param text - string to append
+	 */
+	inline void put(std::vector<char>& buffer, const std::string& text) {
+		buffer.insert(buffer.end(), text.begin(), text.end());
+		buffer.push_back('\0');
+	}
+
+	/**
+	 * reads a value that has been stored in little endian byte order
+	 * @param stream - stream to read from
+	 * @param value - integer or floating point value
+	 */
+	template <typename T>
+	void get(std::istream& stream, T& value) {
+		char bytes[sizeof(T)];
+		if (!stream.read(bytes, sizeof(T))) return;
+		if (!is_little_endian()) std::reverse(bytes, bytes + sizeof(T));
+
+		std::memcpy(&value, bytes, sizeof(T));
+	}
+}
+
+#endif//BINARY_H
\ No newline at end of file
@@ -0,0 +1,185 @@
+#include "hdrimage.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#include "binary.h"
+#include "stb_image_write.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RT_SSE
+#include <immintrin.h>
+#endif
+
+namespace {
+	/**
+	 * appends the name, type and size of an exr header attribute,
+	 * the value has to follow
+	 * @param buffer - buffer to append to
+	 * @param name - name of the attribute
+	 * @param type - type of the attribute
+	 * @param size - size of the value in bytes
+	 */
+	void put_attribute(std::vector<char>& buffer, const std::string& name, const std::string& type, int32_t size) {
+		rt::put(buffer, name);
+		rt::put(buffer, type);
+		rt::put(buffer, size);
+	}
+}
+
+void rt::HDRImage::set(size_t x, size_t y, const vec3& col) {
+	size_t idx = (x + y * m_width) * 3;
+	m_data[idx + 0] = static_cast<float>(col.r);
+	m_data[idx + 1] = static_cast<float>(col.g);
+	m_data[idx + 2] = static_cast<float>(col.b);
+}
+
+rt::vec3 rt::HDRImage::get(size_t x, size_t y) const {
+	size_t idx = (x + y * m_width) * 3;
+	return vec3(m_data[idx + 0], m_data[idx + 1], m_data[idx + 2]);
+}
+
+rt::Image rt::tonemap(const HDRImage& image, double exposure) {
+	Image result(image.width(), image.height(), 3);
+	const float* src = image.data().data();
+	unsigned char* dst = result.data().data();
+	size_t size = image.data().size();
+	float scale = static_cast<float>(exposure);
+
+	// all channels are mapped the same way, thus the data
+	// is processed as a flat array of floats
+	size_t i = 0;
+#ifdef RT_SSE
+	const __m128 vscale = _mm_set1_ps(scale);
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.f);
+	const __m128 quantize = _mm_set1_ps(255.99f);
+	for (; i + 4 <= size; i += 4) {
+		// max returns its second operand for nan, which maps nan to black
+		__m128 c = _mm_mul_ps(_mm_loadu_ps(src + i), vscale);
+		c = _mm_min_ps(_mm_sqrt_ps(_mm_max_ps(c, zero)), one);
+		__m128i q = _mm_cvttps_epi32(_mm_mul_ps(c, quantize));
+
+		// narrow the four 32 bit values down to bytes
+		q = _mm_packs_epi32(q, q);
+		q = _mm_packus_epi16(q, q);
+		int32_t bytes = _mm_cvtsi128_si32(q);
+		std::memcpy(dst + i, &bytes, 4);
+	}
+#endif
+	for (; i < size; ++i) {
+		float c = src[i] * scale;
+		c = (c > 0.f) ? std::sqrt(c) : 0.f;
+		c = std::min(c, 1.f);
+		dst[i] = static_cast<unsigned char>(255.99f * c);
+	}
+
+	return result;
+}
+
+void rt::write_pfm(std::string filename, const HDRImage& image) {
+	// a negative scale marks the data as little endian
+	std::vector<char> buffer;
+	std::string header = "PF\n" + std::to_string(image.width()) + " " + std::to_string(image.height()) + "\n-1.0\n";
+	buffer.insert(buffer.end(), header.begin(), header.end());
+
+	// scanlines are stored from bottom to top
+	for (size_t y = image.height(); y-- > 0;) {
+		for (size_t x = 0; x < image.width(); ++x) {
+			vec3 col = image.get(x, y);
+			put(buffer, static_cast<float>(col.r));
+			put(buffer, static_cast<float>(col.g));
+			put(buffer, static_cast<float>(col.b));
+		}
+	}
+
+	std::ofstream file(filename, std::ios::binary);
+	file.write(buffer.data(), buffer.size());
+}
+
+void rt::write_exr(std::string filename, const HDRImage& image) {
+	int32_t width = static_cast<int32_t>(image.width());
+	int32_t height = static_cast<int32_t>(image.height());
+
+	// magic number and version 2 of a single part scanline file
+	std::vector<char> buffer;
+	put(buffer, int32_t(20000630));
+	put(buffer, int32_t(2));
+
+	// channels are sorted by name, each is stored as 32 bit float
+	const char* channels[] = { "B", "G", "R" };
+	put_attribute(buffer, "channels", "chlist", 3 * 18 + 1);
+	for (const char* channel : channels) {
+		put(buffer, std::string(channel));
+		put(buffer, int32_t(2));
+		put(buffer, int32_t(0));
+		put(buffer, int32_t(1));
+		put(buffer, int32_t(1));
+	}
+	buffer.push_back('\0');
+
+	put_attribute(buffer, "compression", "compression", 1);
+	buffer.push_back('\0');
+	for (const char* window : { "dataWindow", "displayWindow" }) {
+		put_attribute(buffer, window, "box2i", 16);
+		put(buffer, int32_t(0));
+		put(buffer, int32_t(0));
+		put(buffer, width - 1);
+		put(buffer, height - 1);
+	}
+	put_attribute(buffer, "lineOrder", "lineOrder", 1);
+	buffer.push_back('\0');
+	put_attribute(buffer, "pixelAspectRatio", "float", 4);
+	put(buffer, 1.f);
+	put_attribute(buffer, "screenWindowCenter", "v2f", 8);
+	put(buffer, 0.f);
+	put(buffer, 0.f);
+	put_attribute(buffer, "screenWindowWidth", "float", 4);
+	put(buffer, 1.f);
+	buffer.push_back('\0');
+
+	// offset table with one entry per scanline
+	int32_t linesize = 3 * width * static_cast<int32_t>(sizeof(float));
+	uint64_t offset = buffer.size() + image.height() * sizeof(uint64_t);
+	for (int32_t y = 0; y < height; ++y) {
+		put(buffer, offset);
+		offset += 2 * sizeof(int32_t) + linesize;
+	}
+
+	// each scanline stores all values of one channel after another
+	for (int32_t y = 0; y < height; ++y) {
+		put(buffer, y);
+		put(buffer, linesize);
+		for (size_t c = 3; c-- > 0;) {
+			for (int32_t x = 0; x < width; ++x) {
+				put(buffer, static_cast<float>(image.get(x, y)[static_cast<int>(c)]));
+			}
+		}
+	}
+
+	std::ofstream file(filename, std::ios::binary);
+	file.write(buffer.data(), buffer.size());
+}
+
+void rt::write_image(std::string filename, const HDRImage& image) {
+	std::string extension = std::filesystem::path(filename).extension().string();
+	std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+	if (extension == ".pfm") {
+		write_pfm(filename, image);
+	}
+	else if (extension == ".exr") {
+		write_exr(filename, image);
+	}
+	else if (extension == ".hdr") {
+		stbi_write_hdr(filename.c_str(), static_cast<int>(image.width()), static_cast<int>(image.height()), 3, image.data().data());
+	}
+	else {
+		write_image(filename, tonemap(image));
+	}
+}
\ No newline at end of file
@@ -0,0 +1,88 @@
+#ifndef HDR_IMAGE_H
+#define HDR_IMAGE_H
+
+#include <string>
+#include <vector>
+
+#include "image.h"
+#include "math/vec3.h"
+
+namespace rt {
+	/**
+	 * image that stores linear radiance as 32 bit floats per channel.
+	 * the origin of the image is in the upper left corner
+	 */
+	class HDRImage {
+	public:
+		HDRImage() : m_width(0), m_height(0) {}
+		HDRImage(size_t width, size_t height) : m_width(width), m_height(height), m_data(width * height * 3, 0.f) {}
+
+		/**
+		 * returns width of the image
+		 * @return width of the image
+		 */
+		size_t width() const { return m_width; }
+		/**
+		 * returns height of the image
+		 * @return height of the image
+		 */
+		size_t height() const { return m_height; }
+		/**
+		 * returns the raw data as interleaved rgb values
+		 * @return raw data
+		 */
+		const std::vector<float>& data() const { return m_data; }
+
+		/**
+		 * sets pixel color at position (x,y)
+		 * @param x - x-position of the pixel
+		 * @param y - y-position of the pixel
+		 * @param col - linear color, values above 1 are kept
+		 */
+		void set(size_t x, size_t y, const vec3& col);
+		/**
+		 * gets pixel color at position (x,y)
+		 * @param x - x-position of the pixel
+		 * @param y - y-position of the pixel
+		 * @return col at (x,y)
+		 */
+		vec3 get(size_t x, size_t y) const;
+
+	private:
+		size_t m_width;
+		size_t m_height;
+		std::vector<float> m_data;
+	};
+
+	/**
+	 * maps linear radiance to a displayable image. the radiance is scaled
+	 * by the exposure, gamma corrected with gamma 2 and clamped to [0,1]
+	 * @param image - image with linear radiance
+	 * @param exposure - factor applied to the radiance
+	 * @return image with 8 bits per channel
+	 */
+	Image tonemap(const HDRImage& image, double exposure = 1.0);
+
+	/**
+	 * writes the image as portable float map
+	 * @param filename - path to pfm image file
+	 * @param image - image with linear radiance
+	 */
+	void write_pfm(std::string filename, const HDRImage& image);
+	/**
+	 * writes the image as uncompressed openexr file with float channels
+	 * @param filename - path to exr image file
+	 * @param image - image with linear radiance
+	 */
+	void write_exr(std::string filename, const HDRImage& image);
+	/**
+	 * writes the image in the format that matches the file extension.
+	 * pfm, exr and hdr files store the linear radiance, any other
+	 * extension gets the image tone mapped and written as png
+	 * @param filename - path to the image file
+	 * @param image - image with linear radiance
+	 */
+	void write_image(std::string filename, const HDRImage& image);
+}
+
+#endif//HDR_IMAGE_H
\ No newline at end of file
@@ -1,5 +1,7 @@
 #include "image.h"
 
+#include "math/algorithm.h"
+
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 #define STB_IMAGE_WRITE_IMPLEMENTATION
@@ -9,6 +11,7 @@ size_t rt::Image::width()    const { return m_width;    }
 size_t rt::Image::height()   const { return m_height;   }
 size_t rt::Image::channels() const { return m_channels; }
 const std::vector<unsigned char>& rt::Image::data() const { return m_data; }
+std::vector<unsigned char>& rt::Image::data() { return m_data; }
 
 size_t rt::Image::index(size_t x, size_t y) const {
 	return (x + y*m_width)*m_channels;
@@ -16,9 +19,9 @@ size_t rt::Image::index(size_t x, size_t y) const {
 
 void rt::Image::set(size_t x, size_t y, const vec3& col) {
 	size_t idx = index(x, y);
-    m_data[idx+0] = static_cast<unsigned char>(255.99*col.r);
-    m_data[idx+1] = static_cast<unsigned char>(255.99*col.g);
-    m_data[idx+2] = static_cast<unsigned char>(255.99*col.b);
+    m_data[idx+0] = static_cast<unsigned char>(255.99*saturate(col.r));
+    m_data[idx+1] = static_cast<unsigned char>(255.99*saturate(col.g));
+    m_data[idx+2] = static_cast<unsigned char>(255.99*saturate(col.b));
 }
 
 rt::vec3 rt::Image::get(size_t x, size_t y) const {
@@ -43,12 +43,17 @@ namespace rt {
 		 * @return raw data
 		 */
 		const std::vector<unsigned char>& data() const;
+		/**
+		 * returns the raw data for modification
+		 * @return raw data
+		 */
+		std::vector<unsigned char>& data();
 
 		/**
 		 * sets pixel color at position (x,y)
 		 * @param x - x-position of the pixel
 		 * @param y - y-position of the pixel
-		 * @param col - color to update
+		 * @param col - color to update, clamped to [0,1]
 		 */
 		void set(size_t x, size_t y, const vec3& col);
 		/**
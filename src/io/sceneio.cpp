@@ -13,11 +13,20 @@ std::shared_ptr<rt::SceneData> rt::read_scene(std::string scenepath) {
 
 		# tracer statements
 		Tracer        <- 'TRACER' (_ TracerAttrib)*
-		TracerAttrib  <- TracerType / TracerRes / TracerSamples / TracerDepth
+		TracerAttrib  <- TracerType / TracerRes / TracerSamples / TracerMinSamples / TracerError / TracerTime / TracerInterval / TracerPass / TracerCheckpoint / TracerPhotons / TracerCaustics / TracerDepth / TracerThreads
 		TracerType    <- 'TYPE' _ Word
 		TracerRes     <- 'RESOLUTION' _ Number _ Number
 		TracerSamples <- 'SAMPLES' _ Number
+		TracerMinSamples <- 'MINSAMPLES' _ Number
+		TracerError   <- 'ERROR' _ Double
+		TracerTime    <- 'TIME' _ Duration
+		TracerInterval <- 'INTERVAL' _ Duration
+		TracerPass    <- 'PASS' _ Number
+		TracerCheckpoint <- 'CHECKPOINT' _ Duration
+		TracerPhotons <- 'PHOTONS' _ Number
+		TracerCaustics <- 'CAUSTICS' _ Number
 		TracerDepth   <- 'DEPTH' _ Number
+		TracerThreads <- 'THREADS' _ Number
 
 		# camera statements
 		Camera         <- 'CAMERA' (_ CameraAttrib)* 
@@ -49,7 +58,7 @@ std::shared_ptr<rt::SceneData> rt::read_scene(std::string scenepath) {
 		# objects statement
 		Objects             <- 'OBJECTS' (_ Object)*
 		Object              <- 'OBJECT' (_ ObjectAttrib)*
-		ObjectAttrib        <- ObjectName / ObjectType / ObjectPos / ObjectPos2 / ObjectMaterial / ObjectXAxis / ObjectYAxis / ObjectRadius / ObjectWidth / ObjectHeight / ObjectDepth / ObjectMeshPath / ObjectInvert / ObjectMeshNormalize / ObjectMeshSmooth
+		ObjectAttrib        <- ObjectName / ObjectType / ObjectPos / ObjectPos2 / ObjectMaterial / ObjectXAxis / ObjectYAxis / ObjectRadius / ObjectWidth / ObjectHeight / ObjectDepth / ObjectMeshPath / ObjectInvert / ObjectMeshNormalize / ObjectMeshSmooth / ObjectBuilder
 		ObjectName          <- 'NAME' _ Word
 		ObjectType          <- 'TYPE' _ Word
 		ObjectPos           <- 'POS' _ Vector
@@ -65,20 +74,23 @@ std::shared_ptr<rt::SceneData> rt::read_scene(std::string scenepath) {
 		ObjectInvert        <- 'INVERT' _ Bool
 		ObjectMeshNormalize <- 'NORMALIZE' _ Bool
 		ObjectMeshSmooth    <- 'SMOOTH' _ Bool
+		ObjectBuilder       <- 'BUILDER' _ Word
 
 		# scene statement
 		Scene              <- 'SCENE' (_ SceneAttrib)*
-		SceneAttrib        <- SceneType / Elements
+		SceneAttrib        <- SceneType / SceneBuilder / Elements
 		SceneType          <- 'TYPE' _ Word
+		SceneBuilder       <- 'BUILDER' _ Word
 		Elements           <- 'ELEMENTS' (_ Element)*
 		Element            <- 'ELEMENT' (_ ElementAttrib)*
 		ElementAttrib      <- ElementObject / ElementTransform
 		ElementObject      <- 'OBJECT' _ Word
 		ElementTransform   <- 'TRANSFORM' (_ TransformAction)*
 		# transform statement
-		TransformAction    <- TransformTranslate / TransformRotate
+		TransformAction    <- TransformTranslate / TransformRotate / TransformScale
 		TransformTranslate <- 'TRANSLATE' _ Vector
 		TransformRotate    <- 'ROTATE' _ Vector _ Double
+		TransformScale     <- 'SCALE' _ Vector
 
 		# general statements
 		Word        <- [a-z][a-z0-9]*
@@ -86,6 +98,8 @@ std::shared_ptr<rt::SceneData> rt::read_scene(std::string scenepath) {
 		Bool        <- 'true' / 'false'
 		Number      <- [0-9]+
 		Double      <- '-'? [0-9]+ ('.' [0-9]+)?
+		Duration    <- Number TimeUnit?
+		TimeUnit    <- [smh]
 		Vector      <- '(' _ Double _ ',' _ Double _ ',' _ Double _ ')'
         Comment     <- '#' .+ EOL
 		EOL         <- [\r\n]
@@ -99,6 +113,7 @@ std::shared_ptr<rt::SceneData> rt::read_scene(std::string scenepath) {
 
 	// setup scene
 	std::shared_ptr<SceneData> scene = std::make_shared<SceneData>();
+	scene->hash = hash_string(text);
 	scene->success = true;
 
 	// setup parser
@@ -129,6 +144,19 @@ std::shared_ptr<rt::SceneData> rt::read_scene(std::string scenepath) {
 	parser["Double"] = [](const peg::SemanticValues& sv) {
 		return stod(sv.token());
 	};
+	parser["Duration"] = [](const peg::SemanticValues& sv) {
+		double duration = sv[0].get<int>();
+
+		// seconds unless specified otherwise
+		std::string unit = (sv.size() > 1) ? sv[1].get<std::string>() : "s";
+		if      (unit == "m") duration *= 60.0;
+		else if (unit == "h") duration *= 3600.0;
+
+		return duration;
+	};
+	parser["TimeUnit"] = [](const peg::SemanticValues& sv) {
+		return sv.token();
+	};
 	parser["Vector"] = [](const peg::SemanticValues& sv) {
 		double x = sv[0].get<double>();
 		double y = sv[1].get<double>();
@@ -157,22 +185,55 @@ std::shared_ptr<rt::SceneData> rt::read_scene(std::string scenepath) {
 		auto& [width, height] = map_get(attributemap, TRACER_RESOLUTION, std::pair(640, 460));
 		int samples           = map_get(attributemap, TRACER_SAMPLES,    100                );
 		int depth             = map_get(attributemap, TRACER_DEPTH,      100                );
+		int threads           = map_get(attributemap, TRACER_THREADS,    0                  );
+		int minsamples        = map_get(attributemap, TRACER_MIN_SAMPLES, 16                );
+		double error          = map_get(attributemap, TRACER_ERROR,      0.0                );
+		double time           = map_get(attributemap, TRACER_TIME,       0.0                );
+		double interval       = map_get(attributemap, TRACER_INTERVAL,   0.0                );
+		int passsamples       = map_get(attributemap, TRACER_PASS,       4                  );
+		double checkpoint     = map_get(attributemap, TRACER_CHECKPOINT, 0.0                );
+		int photons           = map_get(attributemap, TRACER_PHOTONS,    100000             );
+		int caustics          = map_get(attributemap, TRACER_CAUSTICS,   100000             );
 
 		// create the appropriate tracer
 		switch (type) {
 		case TracerType::RAYCASTER:
 			scene->tracer = std::make_shared<Raycaster>(width, height, samples, depth);
 			break;
-		case TracerType::RAYTRACER:
-			scene->tracer = std::make_shared<Raytracer>(width, height, samples, depth);
+		case TracerType::RAYTRACER: {
+			auto raytracer = std::make_shared<Raytracer>(width, height, samples, depth);
+			// the minimal number of samples lies in [1, samples], a negative
+			// value would wrap around as size_t
+			raytracer->setAdaptive(std::clamp(minsamples, 1, std::max(samples, 1)), error);
+			raytracer->setProgressive(time, interval, passsamples);
+			raytracer->setCheckpointInterval(checkpoint);
+			scene->tracer = raytracer;
 			break;
+		}
 		case TracerType::DEBUGTRACER:
 			scene->tracer = std::make_shared<Debugtracer>(width, height, samples, depth);
 			break;
+		case TracerType::PHOTONMAPPER: {
+			auto photonmapper = std::make_shared<PhotonMapper>(width, height, samples, depth);
+			photonmapper->setPhotons(photons, caustics);
+			scene->tracer = photonmapper;
+			break;
+		}
+		case TracerType::SPPM: {
+			auto sppm = std::make_shared<ProgressivePhotonMapper>(width, height, samples, depth);
+			sppm->setPhotons(photons);
+			sppm->setProgressive(time, interval);
+			scene->tracer = sppm;
+			break;
+		}
+		case TracerType::BDPT:
+			scene->tracer = std::make_shared<BidirectionalPathTracer>(width, height, samples, depth);
+			break;
 		default: // raycaster
 			scene->tracer = std::make_shared<Raycaster>(width, height, samples, depth);
 			break;
 		}
+		scene->tracer->setThreads(threads);
 	};
 	parser["TracerType"] = [](const peg::SemanticValues& sv) {
 		// grab value
@@ -183,6 +244,9 @@ std::shared_ptr<rt::SceneData> rt::read_scene(std::string scenepath) {
 		if     (val == "raycaster"  ) type = TracerType::RAYCASTER;
 		else if(val == "raytracer"  ) type = TracerType::RAYTRACER;
 		else if(val == "debugtracer") type = TracerType::DEBUGTRACER;
+		else if(val == "photonmapper") type = TracerType::PHOTONMAPPER;
+		else if(val == "sppm"       ) type = TracerType::SPPM;
+		else if(val == "bdpt"       ) type = TracerType::BDPT;
 
 		return std::pair(TRACER_TYPE, peg::any(type));
 	};
@@ -200,12 +264,67 @@ std::shared_ptr<rt::SceneData> rt::read_scene(std::string scenepath) {
 
 		return std::pair(TRACER_SAMPLES, peg::any(samples));
 	};
+	parser["TracerMinSamples"] = [](const peg::SemanticValues& sv) {
+		// grab value
+		int minsamples = sv[0].get<int>();
+
+		return std::pair(TRACER_MIN_SAMPLES, peg::any(minsamples));
+	};
+	parser["TracerError"] = [](const peg::SemanticValues& sv) {
+		// grab value
+		double error = sv[0].get<double>();
+
+		return std::pair(TRACER_ERROR, peg::any(error));
+	};
+	parser["TracerTime"] = [](const peg::SemanticValues& sv) {
+		// grab value
+		double time = sv[0].get<double>();
+
+		return std::pair(TRACER_TIME, peg::any(time));
+	};
+	parser["TracerInterval"] = [](const peg::SemanticValues& sv) {
+		// grab value
+		double interval = sv[0].get<double>();
+
+		return std::pair(TRACER_INTERVAL, peg::any(interval));
+	};
+	parser["TracerPass"] = [](const peg::SemanticValues& sv) {
+		// grab value
+		int passsamples = sv[0].get<int>();
+
+		return std::pair(TRACER_PASS, peg::any(passsamples));
+	};
+	parser["TracerCheckpoint"] = [](const peg::SemanticValues& sv) {
+		// grab value
+		double checkpoint = sv[0].get<double>();
+
+		return std::pair(TRACER_CHECKPOINT, peg::any(checkpoint));
+	};
+	parser["TracerPhotons"] = [](const peg::SemanticValues& sv) {
+		// grab value
+		int photons = sv[0].get<int>();
+
+		return std::pair(TRACER_PHOTONS, peg::any(photons));
+	};
+	parser["TracerCaustics"] = [](const peg::SemanticValues& sv) {
+		// grab value
+		int caustics = sv[0].get<int>();
+
+		return std::pair(TRACER_CAUSTICS, peg::any(caustics));
+	};
 	parser["TracerDepth"] = [](const peg::SemanticValues& sv) {
 		// grab value
 		int depth = sv[0].get<int>();
 
 		return std::pair(TRACER_DEPTH, peg::any(depth));
 	};
+	parser["TracerThreads"] = [](const peg::SemanticValues& sv) {
+		// grab value, negative counts would wrap around as size_t thus
+		// they fall back to all hardware threads
+		int threads = std::max(sv[0].get<int>(), 0);
+
+		return std::pair(TRACER_THREADS, peg::any(threads));
+	};
 
 	/**
 	 * building the camera object
@@ -507,7 +626,8 @@ std::shared_ptr<rt::SceneData> rt::read_scene(std::string scenepath) {
 				bool flip = map_get(attributemap, OBJECT_INVERT, false);
 				bool normalize = map_get(attributemap, OBJECT_MESH_NORMALIZE, false);
 				bool smooth = map_get(attributemap, OBJECT_MESH_SMOOTH, false);
-				std::shared_ptr<IHitable> mesh = load_mesh(path, material, flip, normalize, smooth);
+				BuilderType builder = map_get(attributemap, OBJECT_BUILDER, SAH_BUILDER);
+				std::shared_ptr<IHitable> mesh = load_mesh(path, material, flip, normalize, smooth, builder);
 				scene->objects.insert(std::make_pair(name, mesh));
 			}
 			break;
@@ -632,6 +752,12 @@ std::shared_ptr<rt::SceneData> rt::read_scene(std::string scenepath) {
 
 		return std::make_pair(OBJECT_MESH_SMOOTH, peg::any(smooth));
 	};
+	parser["ObjectBuilder"] = [](const peg::SemanticValues& sv) {
+		// grab value
+		std::string val = sv[0].get<std::string>();
+
+		return std::make_pair(OBJECT_BUILDER, peg::any(builder_type(val)));
+	};
 
 	/**
 	 * building the scene
@@ -639,9 +765,18 @@ std::shared_ptr<rt::SceneData> rt::read_scene(std::string scenepath) {
 	parser["Scene"] = [&](const peg::SemanticValues& sv) {
 		// build scene
 		scene->organization->build();
+		if (auto bvh  = std::dynamic_pointer_cast<BVH >(scene->organization)) bvh->print_statistics();
+		if (auto bvh4 = std::dynamic_pointer_cast<BVH4>(scene->organization)) bvh4->print_statistics();
+		if (auto bvh8 = std::dynamic_pointer_cast<BVH8>(scene->organization)) bvh8->print_statistics();
 
-		// add hitable and camera to the tracer
+		// collect the emissive surfaces that get sampled explicitly
+		scene->lights = std::make_shared<LightList>();
+		scene->organization->collect_lights(*scene->lights, affine(), nullptr);
+		scene->lights->build();
+
+		// add hitable, lights and camera to the tracer
 		scene->tracer->setHitable(scene->organization);
+		scene->tracer->setLights(scene->lights);
 		scene->tracer->setCamera(scene->camera);
 	};
 	parser["Element"] = [&](const peg::SemanticValues& sv) {
@@ -654,25 +789,35 @@ std::shared_ptr<rt::SceneData> rt::read_scene(std::string scenepath) {
 		if (map_contains(scene->objects, objectid)) {
 			std::shared_ptr<IHitable> obj = scene->objects.at(objectid);
 
-			// apply transformations to object
+			// fold all transformations into a single affine transformation.
+			// they are applied from top to down, thus later ones are multiplied
+			// from the left
 			std::shared_ptr<IHitable> cur = obj;
+			affine transform;
 			auto transformations = map_get(attributemap, ELEMENT_TRANSFORM, std::vector<std::pair<TransformAttribute, peg::any>>());
 			for (size_t i = 0; i < transformations.size(); ++i) {
 				auto transformation = transformations.at(i);
 				if (transformation.first == TRANSFORM_TRANSLATE) {
 					vec3 offset = transformation.second.get<vec3>();
-					auto translation = std::make_shared<Translation>(cur, offset);
-					cur = translation;
+					transform = affine::translation(offset) * transform;
 				}
 				if (transformation.first == TRANSFORM_ROTATE) {
 					auto axisangle = transformation.second.get<std::pair<vec3, double>>();
 					vec3 axis = axisangle.first;
 					double angle = axisangle.second;
-					auto rotation = std::make_shared<Rotation>(cur, axis, angle);
-					cur = rotation;
+					transform = affine::rotation(axis, angle) * transform;
+				}
+				if (transformation.first == TRANSFORM_SCALE) {
+					vec3 factors = transformation.second.get<vec3>();
+					transform = affine::scaling(factors) * transform;
 				}
 			}
 
+			// transformed elements become instances that share the object
+			if (!transformations.empty()) {
+				cur = std::make_shared<Transform>(obj, transform);
+			}
+
 			if (scene->organization != nullptr) {
 				scene->organization->insert(cur);
 			}
@@ -691,8 +836,20 @@ std::shared_ptr<rt::SceneData> rt::read_scene(std::string scenepath) {
 
 		// determine scene typ
 		if     (val == "bvh" ) scene->organization = std::make_shared<BVH>();
+		else if(val == "bvh4") scene->organization = std::make_shared<BVH4>();
+		else if(val == "bvh8") scene->organization = std::make_shared<BVH8>();
 		else if(val == "list") scene->organization = std::make_shared<HitableList>();
 	};
+	parser["SceneBuilder"] = [&](const peg::SemanticValues& sv) {
+		// grab value
+		std::string val = sv[0].get<std::string>();
+
+		// only hierarchies make use of a builder
+		BuilderType builder = builder_type(val);
+		if (auto bvh  = std::dynamic_pointer_cast<BVH >(scene->organization)) bvh->set_builder(builder);
+		if (auto bvh4 = std::dynamic_pointer_cast<BVH4>(scene->organization)) bvh4->set_builder(builder);
+		if (auto bvh8 = std::dynamic_pointer_cast<BVH8>(scene->organization)) bvh8->set_builder(builder);
+	};
 	parser["ElementTransform"] = [](const peg::SemanticValues& sv) {
 		// grab all values in order
 		std::vector<std::pair<TransformAttribute, peg::any>> transformations;
@@ -714,6 +871,17 @@ std::shared_ptr<rt::SceneData> rt::read_scene(std::string scenepath) {
 		auto axisangle = std::make_pair(axis, angle);
 		return std::make_pair(TRANSFORM_ROTATE, peg::any(axisangle));
 	};
+	parser["TransformScale"] = [](const peg::SemanticValues& sv) {
+		// grab value
+		vec3 factors = sv[0].get<vec3>();
+
+		// a zero factor collapses the object and its inverse doesn't exist
+		if (factors[0] == 0.0 || factors[1] == 0.0 || factors[2] == 0.0) {
+			throw peg::parse_error("scale factors must not be zero");
+		}
+
+		return std::make_pair(TRANSFORM_SCALE, peg::any(factors));
+	};
 
 
 
@@ -1,6 +1,7 @@
 #ifndef SCENE_IO_H
 #define SCENE_IO_H
 
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <fstream>
@@ -9,7 +10,9 @@
 #include "peglib.h"
 
 #include "hitable/hitable.h"
+#include "light/light.h"
 #include "material/material.h"
+#include "math/affine.h"
 #include "math/vec3.h"
 #include "texture/texture.h"
 #include "tracer/tracer.h"
@@ -24,19 +27,33 @@ namespace rt {
 		std::map<std::string, std::shared_ptr<IHitable>> objects;
 		std::shared_ptr<IOrganization> organization;
 		std::shared_ptr<IHitable> world;
+		std::shared_ptr<LightList> lights;
+		uint64_t hash;
 		bool success;
 	};
 
 	enum TracerType {
 		RAYCASTER,
 		RAYTRACER,
-		DEBUGTRACER
+		DEBUGTRACER,
+		PHOTONMAPPER,
+		SPPM,
+		BDPT
 	};
 	enum TracerAttribute {
 		TRACER_TYPE,
 		TRACER_RESOLUTION,
 		TRACER_SAMPLES,
-		TRACER_DEPTH
+		TRACER_MIN_SAMPLES,
+		TRACER_ERROR,
+		TRACER_TIME,
+		TRACER_INTERVAL,
+		TRACER_PASS,
+		TRACER_CHECKPOINT,
+		TRACER_PHOTONS,
+		TRACER_CAUSTICS,
+		TRACER_DEPTH,
+		TRACER_THREADS
 	};
 	enum CameraType {
 		SIMPLE_CAMERA,
@@ -95,14 +112,18 @@ namespace rt {
 		OBJECT_INVERT,
 		OBJECT_MESH_PATH,
 		OBJECT_MESH_NORMALIZE,
-		OBJECT_MESH_SMOOTH
+		OBJECT_MESH_SMOOTH,
+		OBJECT_BUILDER
 	};
 	enum SceneType {
 		SCENE_BVH,
+		SCENE_BVH4,
+		SCENE_BVH8,
 		SCENE_LIST
 	};
 	enum SceneAttribute {
-		SCENE_TYPE
+		SCENE_TYPE,
+		SCENE_BUILDER
 	};
 	enum ElementAttribute {
 		ELEMENT_OBJECT,
@@ -110,7 +131,8 @@ namespace rt {
 	};
 	enum TransformAttribute {
 		TRANSFORM_TRANSLATE,
-		TRANSFORM_ROTATE
+		TRANSFORM_ROTATE,
+		TRANSFORM_SCALE
 	};
 
 	struct SceneElement {
@@ -123,6 +145,16 @@ namespace rt {
 	};
 
 	std::shared_ptr<SceneData> read_scene(std::string scenepath);
+
+	/**
+	 * determines the hierarchy builder from its name in the scene file
+	 * @param name - either sah or parallel
+	 * @return type of the builder, serial sah for unknown names
+	 */
+	inline BuilderType builder_type(const std::string& name) {
+		if (name == "parallel") return PARALLEL_SAH_BUILDER;
+		return SAH_BUILDER;
+	}
 	
 	template <typename T, typename S>
 	inline bool map_contains(std::map<T, S>& m, T elem) {
@@ -0,0 +1,101 @@
+#ifndef I_LIGHT_H
+#define I_LIGHT_H
+
+#include <algorithm>
+#include <cmath>
+
+#include "hitable/ihitable.h"
+#include "material/imaterial.h"
+#include "math/constants.h"
+#include "math/sampling.h"
+
+namespace rt {
+	/**
+	 * point that has been sampled on the surface of a light
+	 */
+	struct LightSample {
+		vec3 p;
+		vec3 normal;
+		vec3 radiance;
+		double pdf;
+	};
+
+	/**
+	 * interface for all lights. a light is the emissive surface of a hitable
+	 * that can be sampled explicitly from a point in the scene
+	 */
+	class ILight {
+	public:
+		/**
+		 * samples a point on the light as seen from a reference point
+		 * @param ref - point that gets illuminated
+		 * @param u1 - first random number in [0,1)
+		 * @param u2 - second random number in [0,1)
+		 * @param sample - sampled point, its emitted radiance and the pdf w.r.t. solid angle
+		 * @return true if a point could be sampled
+		 */
+		virtual bool sample(const vec3& ref, double u1, double u2, LightSample& sample) const = 0;
+		/**
+		 * returns the density with which sample() picks a point
+		 * @param ref - point that gets illuminated
+		 * @param p - point on the light
+		 * @param normal - normal of the light at p
+		 * @return pdf w.r.t. solid angle at ref
+		 */
+		virtual double pdf(const vec3& ref, const vec3& p, const vec3& normal) const = 0;
+		/**
+		 * samples a point on the light and a direction into which the light
+		 * is emitted, which is where photons and light paths start
+		 * @param u1 - first random number for the point
+		 * @param u2 - second random number for the point
+		 * @param u3 - first random number for the direction
+		 * @param u4 - second random number for the direction
+		 * @param sample - sampled point, radiance emitted along dir and the pdf w.r.t. area
+		 * @param dir - normalized direction of the emitted light
+		 * @param pdfdir - pdf of the direction w.r.t. solid angle
+		 * @return true if a point and a direction could be sampled
+		 */
+		virtual bool sample_emission(double u1, double u2, double u3, double u4, LightSample& sample, vec3& dir, double& pdfdir) const = 0;
+		/**
+		 * returns the densities with which sample_emission() picks a point and a direction
+		 * @param p - point on the light
+		 * @param normal - normal of the light at p
+		 * @param dir - normalized direction of the emitted light
+		 * @param pdfpos - pdf of the point w.r.t. area
+		 * @param pdfdir - pdf of the direction w.r.t. solid angle
+		 */
+		virtual void pdf_emission(const vec3& p, const vec3& normal, const vec3& dir, double& pdfpos, double& pdfdir) const = 0;
+		/**
+		 * estimates the emitted power which is used to pick between lights
+		 * @return relative power of the light
+		 */
+		virtual double power() const = 0;
+	};
+
+	/**
+	 * evaluates the light that a point of a hitable emits towards a reference
+	 * point. the surface data is computed by the interaction of the hitable
+	 * as if it had been hit by a ray starting at the reference point
+	 * @param instance - instance that contains the object or nullptr
+	 * @param object - emissive object
+	 * @param primitive - primitive of the object
+	 * @param b1 - second barycentric coordinate for triangles
+	 * @param b2 - third barycentric coordinate for triangles
+	 * @param ref - reference point
+	 * @param p - point on the surface of the object
+	 * @return emitted radiance
+	 */
+	inline vec3 emitted_radiance(const IHitable* instance, const IHitable* object, uint32_t primitive, double b1, double b2, const vec3& ref, const vec3& p) {
+		HitRecord rec;
+		rec.t = 1.0;
+		rec.object = object;
+		rec.instance = instance;
+		rec.primitive = primitive;
+		rec.b1 = b1;
+		rec.b2 = b2;
+		complete_interaction(ray(ref, p - ref), rec);
+		return rec.material->emitted(rec.u, rec.v, rec.lp);
+	}
+}
+
+#endif//I_LIGHT_H
\ No newline at end of file
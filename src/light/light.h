@@ -0,0 +1,9 @@
+#ifndef LIGHT_H
+#define LIGHT_H
+
+#include "ilight.h"
+#include "lightlist.h"
+#include "spherelight.h"
+#include "trianglelight.h"
+
+#endif//LIGHT_H
\ No newline at end of file
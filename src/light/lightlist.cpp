@@ -0,0 +1,81 @@
+#include "lightlist.h"
+
+#include <algorithm>
+#include <cmath>
+
+void rt::LightList::add(std::shared_ptr<ILight> light, const IHitable* instance, const IHitable* object, uint32_t primitive) {
+	m_lights.push_back(light);
+	m_keys.push_back({ instance, object, primitive });
+}
+
+void rt::LightList::build() {
+	m_lookup.clear();
+	m_cdf.clear();
+	m_totalpower = 0;
+
+	// prefix sum over the power of all lights
+	m_cdf.reserve(m_lights.size());
+	for (size_t i = 0; i < m_lights.size(); ++i) {
+		m_lookup[m_keys[i]] = i;
+		m_totalpower += std::max(0.0, m_lights[i]->power());
+		m_cdf.push_back(m_totalpower);
+	}
+}
+
+const rt::ILight* rt::LightList::pick(double u, double& pdf) const {
+	if (m_lights.empty()) return nullptr;
+
+	// lights are picked uniformly if none of them emits anything measurable
+	size_t index;
+	if (m_totalpower > 0) {
+		auto it = std::upper_bound(m_cdf.begin(), m_cdf.end(), u * m_totalpower);
+		index = std::min(static_cast<size_t>(it - m_cdf.begin()), m_lights.size() - 1);
+	}
+	else {
+		index = std::min(static_cast<size_t>(u * m_lights.size()), m_lights.size() - 1);
+	}
+
+	pdf = probability(index);
+	return m_lights[index].get();
+}
+
+double rt::LightList::pdf(const vec3& ref, const HitRecord& rec) const {
+	auto it = m_lookup.find({ rec.instance, rec.object, rec.primitive });
+	if (it == m_lookup.end()) return 0.0;
+
+	return probability(it->second) * m_lights[it->second]->pdf(ref, rec.p, rec.normal);
+}
+
+const rt::ILight* rt::LightList::find(const HitRecord& rec, double& pdf) const {
+	auto it = m_lookup.find({ rec.instance, rec.object, rec.primitive });
+	if (it == m_lookup.end()) return nullptr;
+
+	pdf = probability(it->second);
+	return m_lights[it->second].get();
+}
+
+bool rt::LightList::emit(double u1, double u2, double u3, double u4, double u5, ray& r, vec3& power) const {
+	// pick a light, a point on it and a direction
+	double pickpdf;
+	const ILight* light = pick(u1, pickpdf);
+	if (light == nullptr) return false;
+
+	LightSample sample;
+	vec3 dir;
+	double pdfdir;
+	if (!light->sample_emission(u2, u3, u4, u5, sample, dir, pdfdir)) return false;
+
+	double cosine = std::fabs(dot(sample.normal, dir));
+	power = sample.radiance * (cosine / (pickpdf * sample.pdf * pdfdir));
+	if (max_comp(power) <= 0.0) return false;
+
+	r = ray(sample.p, dir);
+	return true;
+}
+
+double rt::LightList::probability(size_t index) const {
+	if (m_totalpower <= 0) return 1.0 / m_lights.size();
+
+	double previous = (index == 0) ? 0.0 : m_cdf[index - 1];
+	return (m_cdf[index] - previous) / m_totalpower;
+}
\ No newline at end of file
@@ -0,0 +1,109 @@
+#ifndef LIGHT_LIST_H
+#define LIGHT_LIST_H
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "ilight.h"
+
+namespace rt {
+	/**
+	 * all lights of a scene that can be sampled explicitly. lights are picked
+	 * proportional to their power. hits of a light are identified by the
+	 * instance, object and primitive stored in the hit record
+	 */
+	class LightList {
+	public:
+		LightList() : m_totalpower(0) {}
+
+		/**
+		 * adds a light to the list
+		 * @param light - light to add
+		 * @param instance - instance reported by hits of the light
+		 * @param object - object reported by hits of the light
+		 * @param primitive - primitive reported by hits of the light
+		 */
+		void add(std::shared_ptr<ILight> light, const IHitable* instance, const IHitable* object, uint32_t primitive);
+		/**
+		 * builds the distribution for picking lights, has
+		 * to be called after all lights have been added
+		 */
+		void build();
+
+		/**
+		 * returns the number of lights
+		 * @return number of lights
+		 */
+		size_t size() const { return m_lights.size(); }
+		/**
+		 * checks if there are no lights
+		 * @return true if the list is empty
+		 */
+		bool empty() const { return m_lights.empty(); }
+
+		/**
+		 * picks a light proportional to its power
+		 * @param u - random number in [0,1)
+		 * @param pdf - probability of picking the light
+		 * @return picked light or nullptr if the list is empty
+		 */
+		const ILight* pick(double u, double& pdf) const;
+		/**
+		 * returns the density with which a light sample ends up at a hit,
+		 * that includes the probability of picking the light
+		 * @param ref - point that gets illuminated
+		 * @param rec - hit record of the emitting surface
+		 * @return pdf w.r.t. solid angle, 0 if the hit object isn't a light
+		 */
+		double pdf(const vec3& ref, const HitRecord& rec) const;
+		/**
+		 * finds the light that has been hit
+		 * @param rec - hit record of the emitting surface
+		 * @param pdf - probability of picking the light
+		 * @return light or nullptr if the hit object isn't a light
+		 */
+		const ILight* find(const HitRecord& rec, double& pdf) const;
+		/**
+		 * samples a photon leaving one of the lights, the light is picked
+		 * proportional to its power
+		 * @param u1 - random number for picking the light
+		 * @param u2 - first random number for the point
+		 * @param u3 - second random number for the point
+		 * @param u4 - first random number for the direction
+		 * @param u5 - second random number for the direction
+		 * @param r - ray along which the photon leaves the light
+		 * @param power - power of the photon, that is the emitted power
+		 *                of all lights if it were the only photon
+		 * @return true if a photon could be emitted
+		 */
+		bool emit(double u1, double u2, double u3, double u4, double u5, ray& r, vec3& power) const;
+
+	private:
+		struct Key {
+			const IHitable* instance;
+			const IHitable* object;
+			uint32_t primitive;
+
+			bool operator==(const Key& k) const { return instance == k.instance && object == k.object && primitive == k.primitive; }
+		};
+		struct KeyHash {
+			size_t operator()(const Key& k) const {
+				size_t h = std::hash<const void*>()(k.instance);
+				h ^= std::hash<const void*>()(k.object) + 0x9e3779b9 + (h << 6) + (h >> 2);
+				h ^= std::hash<uint32_t>()(k.primitive) + 0x9e3779b9 + (h << 6) + (h >> 2);
+				return h;
+			}
+		};
+
+		std::vector<std::shared_ptr<ILight>> m_lights;
+		std::vector<Key> m_keys;
+		std::unordered_map<Key, size_t, KeyHash> m_lookup;
+		std::vector<double> m_cdf;
+		double m_totalpower;
+
+		double probability(size_t index) const;
+	};
+}
+
+#endif//LIGHT_LIST_H
\ No newline at end of file
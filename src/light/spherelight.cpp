@@ -0,0 +1,104 @@
+#include "spherelight.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "math/constants.h"
+#include "math/sampling.h"
+
+rt::SphereLight::SphereLight(vec3 center, double radius, const IHitable* instance, const IHitable* object)
+	: m_center(center), m_radius(radius), m_instance(instance), m_object(object) { }
+
+bool rt::SphereLight::sample(const vec3& ref, double u1, double u2, LightSample& sample) const {
+	vec3 w = m_center - ref;
+	double distance2 = dot(w, w);
+	double radius2 = m_radius * m_radius;
+
+	if (distance2 <= radius2) {
+		// inside of the sphere, sample its surface uniformly
+		sample.normal = uniform_sphere(u1, u2);
+		sample.p = m_center + m_radius * sample.normal;
+	}
+	else {
+		// sample the cone of directions towards the sphere, 1-cos(theta max)
+		// is computed from sin^2 to stay accurate for small and far spheres
+		double distance = std::sqrt(distance2);
+		w /= distance;
+		double sin2max = radius2 / distance2;
+		double cosmax = std::sqrt(std::max(0.0, 1.0 - sin2max));
+		vec3 local = sphere_cap(u1, u2, sin2max / (1.0 + cosmax));
+		double cosine = local.z;
+		double sine = std::sqrt(local.x * local.x + local.y * local.y);
+
+		// orthonormal basis around the direction to the center
+		vec3 u, v;
+		orthonormal_basis(w, u, v);
+		vec3 dir = local.x * u + local.y * v + local.z * w;
+
+		// closest intersection of the direction with the sphere
+		double b = distance * cosine;
+		double t = b - std::sqrt(std::max(0.0, radius2 - distance2 * sine * sine));
+		sample.p = ref + t * dir;
+		sample.normal = normalize(sample.p - m_center);
+	}
+
+	sample.pdf = pdf(ref, sample.p, sample.normal);
+	if (sample.pdf <= 0.0) return false;
+
+	sample.radiance = emitted_radiance(m_instance, m_object, 0, 0.0, 0.0, ref, sample.p);
+	return true;
+}
+
+double rt::SphereLight::pdf(const vec3& ref, const vec3& p, const vec3& normal) const {
+	vec3 w = m_center - ref;
+	double distance2 = dot(w, w);
+	double radius2 = m_radius * m_radius;
+
+	if (distance2 <= radius2) {
+		// uniform density over the area converted to solid angle
+		vec3 d = p - ref;
+		double d2 = dot(d, d);
+		double cosine = std::fabs(dot(normal, d)) / std::sqrt(d2);
+		if (cosine <= 0.0) return 0.0;
+		return d2 / (cosine * 2.0 * TWO_PI * radius2);
+	}
+
+	// uniform density over the cone
+	double sin2max = radius2 / distance2;
+	double cosmax = std::sqrt(std::max(0.0, 1.0 - sin2max));
+	return sphere_cap_pdf(sin2max / (1.0 + cosmax));
+}
+
+bool rt::SphereLight::sample_emission(double u1, double u2, double u3, double u4, LightSample& sample, vec3& dir, double& pdfdir) const {
+	if (m_radius <= 0.0) return false;
+
+	// uniform point on the surface, light leaves it to the outside
+	sample.normal = uniform_sphere(u1, u2);
+	sample.p = m_center + m_radius * sample.normal;
+	sample.pdf = 1.0 / (2.0 * TWO_PI * m_radius * m_radius);
+
+	dir = cosine_direction(sample.normal, u3, u4);
+	pdfdir = dot(sample.normal, dir) / PI;
+	if (pdfdir <= 0.0) return false;
+
+	sample.radiance = emitted_radiance(m_instance, m_object, 0, 0.0, 0.0, sample.p + dir, sample.p);
+	return true;
+}
+
+void rt::SphereLight::pdf_emission(const vec3& p, const vec3& /*normal*/, const vec3& dir, double& pdfpos, double& pdfdir) const {
+	if (m_radius <= 0.0) {
+		pdfpos = pdfdir = 0.0;
+		return;
+	}
+
+	// the normal of the hit might face inwards, the light leaves to the outside
+	pdfpos = 1.0 / (2.0 * TWO_PI * m_radius * m_radius);
+	pdfdir = std::max<double>(0.0, dot(normalize(p - m_center), dir)) / PI;
+}
+
+double rt::SphereLight::power() const {
+	// emission at the top of the sphere seen from a point above it
+	vec3 top = m_center + vec3(0, m_radius, 0);
+	vec3 radiance = emitted_radiance(m_instance, m_object, 0, 0.0, 0.0, top + vec3(0, m_radius, 0), top);
+	return max_comp(radiance) * 2.0 * TWO_PI * m_radius * m_radius;
+}
\ No newline at end of file
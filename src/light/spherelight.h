@@ -0,0 +1,36 @@
+#ifndef SPHERE_LIGHT_H
+#define SPHERE_LIGHT_H
+
+#include "ilight.h"
+
+namespace rt {
+	/**
+	 * emissive sphere in world space. points outside of the sphere sample
+	 * the cone of directions that the sphere covers, points inside sample
+	 * its surface uniformly
+	 */
+	class SphereLight : public ILight {
+	public:
+		/**
+		 * @param center - center in world space
+		 * @param radius - radius in world space
+		 * @param instance - instance that contains the sphere or nullptr
+		 * @param object - hitable that reports hits of the sphere
+		 */
+		SphereLight(vec3 center, double radius, const IHitable* instance, const IHitable* object);
+
+		virtual bool sample(const vec3& ref, double u1, double u2, LightSample& sample) const override;
+		virtual double pdf(const vec3& ref, const vec3& p, const vec3& normal) const override;
+		virtual bool sample_emission(double u1, double u2, double u3, double u4, LightSample& sample, vec3& dir, double& pdfdir) const override;
+		virtual void pdf_emission(const vec3& p, const vec3& normal, const vec3& dir, double& pdfpos, double& pdfdir) const override;
+		virtual double power() const override;
+
+	private:
+		vec3 m_center;
+		double m_radius;
+		const IHitable* m_instance;
+		const IHitable* m_object;
+	};
+}
+
+#endif//SPHERE_LIGHT_H
\ No newline at end of file
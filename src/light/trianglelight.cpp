@@ -0,0 +1,74 @@
+#include "trianglelight.h"
+
+#include <cmath>
+
+#include "math/constants.h"
+#include "math/sampling.h"
+
+rt::TriangleLight::TriangleLight(vec3 p1, vec3 p2, vec3 p3, const IHitable* instance, const IHitable* object, uint32_t primitive)
+	: m_p1(p1), m_p2(p2), m_p3(p3), m_instance(instance), m_object(object), m_primitive(primitive) {
+	vec3 n = cross(p2 - p1, p3 - p1);
+	m_area = 0.5 * n.length();
+	m_normal = (m_area > 0.0) ? normalize(n) : vec3(0);
+}
+
+bool rt::TriangleLight::sample(const vec3& ref, double u1, double u2, LightSample& sample) const {
+	if (m_area <= 0.0) return false;
+
+	// uniformly distributed barycentric coordinates, the weights
+	// of p1, p2 and p3 are (1-b1-b2), b1 and b2
+	double b1, b2;
+	uniform_triangle(u1, u2, b1, b2);
+	sample.p = (1.0 - b1 - b2) * m_p1 + b1 * m_p2 + b2 * m_p3;
+	sample.normal = m_normal;
+
+	// light is emitted on both sides
+	sample.pdf = pdf(ref, sample.p, sample.normal);
+	if (sample.pdf <= 0.0) return false;
+
+	sample.radiance = emitted_radiance(m_instance, m_object, m_primitive, b1, b2, ref, sample.p);
+	return true;
+}
+
+double rt::TriangleLight::pdf(const vec3& ref, const vec3& p, const vec3& normal) const {
+	// convert the uniform density over the area to solid angle
+	vec3 d = p - ref;
+	double distance2 = dot(d, d);
+	double cosine = std::fabs(dot(normal, d)) / std::sqrt(distance2);
+	if (cosine <= 0.0 || m_area <= 0.0) return 0.0;
+
+	return distance2 / (cosine * m_area);
+}
+
+bool rt::TriangleLight::sample_emission(double u1, double u2, double u3, double u4, LightSample& sample, vec3& dir, double& pdfdir) const {
+	if (m_area <= 0.0) return false;
+
+	double b1, b2;
+	uniform_triangle(u1, u2, b1, b2);
+	sample.p = (1.0 - b1 - b2) * m_p1 + b1 * m_p2 + b2 * m_p3;
+	sample.pdf = 1.0 / m_area;
+
+	// light is emitted on both sides, u3 picks the side
+	sample.normal = (u3 < 0.5) ? m_normal : -m_normal;
+	u3 = (u3 < 0.5) ? 2.0 * u3 : 2.0 * u3 - 1.0;
+	dir = cosine_direction(sample.normal, u3, u4);
+	pdfdir = 0.5 * dot(sample.normal, dir) / PI;
+	if (pdfdir <= 0.0) return false;
+
+	sample.radiance = emitted_radiance(m_instance, m_object, m_primitive, b1, b2, sample.p + dir, sample.p);
+	return true;
+}
+
+void rt::TriangleLight::pdf_emission(const vec3& /*p*/, const vec3& /*normal*/, const vec3& dir, double& pdfpos, double& pdfdir) const {
+	pdfpos = (m_area > 0.0) ? 1.0 / m_area : 0.0;
+	pdfdir = 0.5 * std::fabs(dot(m_normal, dir)) / PI;
+}
+
+double rt::TriangleLight::power() const {
+	if (m_area <= 0.0) return 0.0;
+
+	// emission at the centroid seen from a point in front of the triangle
+	vec3 centroid = (m_p1 + m_p2 + m_p3) / 3.0;
+	vec3 radiance = emitted_radiance(m_instance, m_object, m_primitive, 1.0 / 3.0, 1.0 / 3.0, centroid + m_normal, centroid);
+	return max_comp(radiance) * m_area;
+}
\ No newline at end of file
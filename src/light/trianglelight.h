@@ -0,0 +1,39 @@
+#ifndef TRIANGLE_LIGHT_H
+#define TRIANGLE_LIGHT_H
+
+#include "ilight.h"
+
+namespace rt {
+	/**
+	 * emissive triangle in world space. rectangles, cubes and meshes
+	 * are split into triangle lights
+	 */
+	class TriangleLight : public ILight {
+	public:
+		/**
+		 * @param p1 - first vertex in world space
+		 * @param p2 - second vertex in world space
+		 * @param p3 - third vertex in world space
+		 * @param instance - instance that contains the object or nullptr
+		 * @param object - hitable that reports hits of the triangle
+		 * @param primitive - primitive id of the triangle within the object
+		 */
+		TriangleLight(vec3 p1, vec3 p2, vec3 p3, const IHitable* instance, const IHitable* object, uint32_t primitive);
+
+		virtual bool sample(const vec3& ref, double u1, double u2, LightSample& sample) const override;
+		virtual double pdf(const vec3& ref, const vec3& p, const vec3& normal) const override;
+		virtual bool sample_emission(double u1, double u2, double u3, double u4, LightSample& sample, vec3& dir, double& pdfdir) const override;
+		virtual void pdf_emission(const vec3& p, const vec3& normal, const vec3& dir, double& pdfpos, double& pdfdir) const override;
+		virtual double power() const override;
+
+	private:
+		vec3 m_p1, m_p2, m_p3;
+		vec3 m_normal;
+		double m_area;
+		const IHitable* m_instance;
+		const IHitable* m_object;
+		uint32_t m_primitive;
+	};
+}
+
+#endif//TRIANGLE_LIGHT_H
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include <string>
+#include <vector>
 
 #include "io/sceneio.h"
 
@@ -9,18 +10,34 @@ int main(int argc, char* argv[]) {
 	// list of required parameters
 	std::string scenepath;
 	std::string imagepath = "unnamed.png";
+	// list of optional parameters
+	int threads = -1;
+	bool resume = false;
 
 	// grab parameters from console input
-	if (argc == 2) {
-		scenepath = std::string(argv[1]);
+	std::vector<std::string> positionals;
+	for (int i = 1; i < argc; ++i) {
+		std::string arg(argv[i]);
+		if ((arg == "--threads" || arg == "-t") && i + 1 < argc) {
+			threads = std::stoi(argv[++i]);
+		}
+		else if (arg == "--resume" || arg == "-r") {
+			resume = true;
+		}
+		else {
+			positionals.push_back(arg);
+		}
 	}
-	else if (argc == 3) {
-		scenepath = std::string(argv[1]);
-		imagepath = std::string(argv[2]);
+	if (positionals.size() == 1) {
+		scenepath = positionals.at(0);
+	}
+	else if (positionals.size() == 2) {
+		scenepath = positionals.at(0);
+		imagepath = positionals.at(1);
 	}
 	else {
 		console::println("Invalid number of command line arguments!");
-		console::println("Should be SCENE_PATH (OUTPUT_FILE_PATH)");
+		console::println("Should be SCENE_PATH (OUTPUT_FILE_PATH) (--threads N) (--resume)");
 		exit(-1);
 	}
 
@@ -28,8 +45,13 @@ int main(int argc, char* argv[]) {
 	auto scene = read_scene(scenepath);
 	if (!scene->success) return 1;
 
+	// the thread count of the command line overrides the scene file
+	if (threads >= 0) scene->tracer->setThreads(threads);
+
 	// run tracer
 	scene->tracer->setBackgroundColor(vec3(0, 0, 0));
+	scene->tracer->setOutput(imagepath);
+	scene->tracer->setCheckpoint(imagepath + ".checkpoint", resume, scene->hash);
 	scene->tracer->run();
 	scene->tracer->write(imagepath);
 	console::println("Saved result at " + imagepath);
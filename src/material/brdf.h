@@ -1,72 +1,92 @@
 #ifndef BRDF_H
 #define BRDF_H
 
+#include <algorithm>
+#include <cmath>
+
 #include "imaterial.h"
 #include "math/constants.h"
+#include "math/sampling.h"
 #include "texture/itexture.h"
 
 namespace rt {
+	/**
+	 * cook-torrance brdf with a ggx microfacet distribution. the diffuse
+	 * lobe is weighted by kd and the specular lobe by 1-kd, scatter()
+	 * picks one of them with the same probabilities. the specular lobe
+	 * samples only the microfacet normals that are visible from the
+	 * viewer, which keeps the weights close to the fresnel term
+	 */
 	class BRDF : public IMaterial {
 	public:
 		BRDF(std::shared_ptr<ITexture> a, double metalness, double kd, double roughness)
-			: m_albedo(a), m_metalness(metalness), m_kd(kd), m_roughness(roughness) {}
+			: m_albedo(a), m_metalness(metalness), m_kd(saturate(kd)), m_roughness(std::max(roughness, 0.001)) {}
 
 		virtual bool scatter(const ray& rin, const HitRecord& rec, vec3& attenuation, ray& scattered) const {
-			// cook-torrance brdf
-
-			// get surface color
-			vec3 surfacecolor = m_albedo->value(rec.u, rec.v, rec.lp);
-			vec3 f0 = lerp(vec3(0.04), surfacecolor, m_metalness);
+			vec3 n = normalize(rec.normal);
+			vec3 wo = normalize(-rin.dir);
+			if (dot(n, wo) <= 0.0) return false;
 
 			// generate random number to determine wether we
-			// perform a diffuse reflection or aspecular reflection
+			// perform a diffuse reflection or a specular reflection
 			double r = drand();
-
-			// diffuse component
-			if (r <= m_kd) {
-				// lambertian reflection
-				vec3 target = rec.p + rec.normal + randomDir();
-				vec3 dir = normalize(target - rec.p);
-				scattered = ray(rec.p, dir);
-
-				attenuation = m_kd * surfacecolor / PI;
+			double u1 = drand();
+			double u2 = drand();
+			vec3 wi;
+			if (r < m_kd) {
+				wi = cosine_direction(n, u1, u2);
 			}
-			// specular component
 			else {
-				// mirror reflection
-				vec3 reflected = reflect(normalize(rin.dir), normalize(rec.normal));
-				scattered = ray(rec.p, reflected);
-
-				// grab all relevant vectors and the roughness
-				double a = m_roughness;
-				vec3 n = normalize(rec.normal);
-				vec3 l = normalize(-rin.dir);
-				vec3 v = normalize(reflected);
-				vec3 h = normalize(l + v);
-
-				// mapping between roughness and parameter k
-				// for the fresnel schlick approximation
-				double k = (a * a) / 2.0;
+				// mirror the viewer at a visible microfacet normal
+				vec3 h = sample_visible_normal(n, wo, u1, u2);
+				wi = reflect(-wo, h);
+			}
 
-				// compute dot products
-				double ndotl = saturate(dot(n, l));
-				double ndoth = saturate(dot(n, h));
-				double ldoth = saturate(dot(l, h));
-				double ndotv = saturate(dot(n, v));
+			// the sampled direction is weighted by the whole brdf
+			// and the combined density of both lobes
+			double p = pdf(rec, wo, wi);
+			if (p <= 0.0) return false;
+			scattered = ray(rec.p, wi);
+			attenuation = eval(rec, wo, wi) / p;
+			return true;
+		}
 
-				// calculate brdf
-				double d = normal_distribution_ggx(ndoth, a);
-				double g = geometry_smith(ndotl, ndotv, k);
-				vec3 f = fresnel_schlick(ldoth, f0);
+		virtual bool is_specular() const override { return false; }
+		virtual vec3 eval(const HitRecord& rec, const vec3& wo, const vec3& wi) const override {
+			vec3 n = normalize(rec.normal);
+			double ndotwo = dot(n, wo);
+			double ndotwi = dot(n, wi);
+			if (ndotwo <= 0.0 || ndotwi <= 0.0) return vec3(0);
 
-				double denom = std::max(4 * ndotl * ndotv, 1.0);
+			// get surface color
+			vec3 surfacecolor = m_albedo->value(rec.u, rec.v, rec.lp);
+			vec3 f0 = lerp(vec3(0.04), surfacecolor, m_metalness);
 
-				vec3 ggx = (d * f * g) / denom;
+			// diffuse component
+			vec3 diffuse = m_kd * surfacecolor * (ndotwi / PI);
 
-				attenuation = ggx;
-			}
+			// specular component, d*f*g / (4*ndotwo*ndotwi) times ndotwi
+			vec3 h = normalize(wo + wi);
+			double d = normal_distribution_ggx(dot(n, h), m_roughness);
+			double g = geometry_smith(ndotwo, ndotwi, m_roughness);
+			vec3 f = fresnel_schlick(saturate(dot(wi, h)), f0);
+			vec3 specular = (1.0 - m_kd) * (d * g / (4.0 * ndotwo)) * f;
 
-			return true;
+			return diffuse + specular;
+		}
+		virtual double pdf(const HitRecord& rec, const vec3& wo, const vec3& wi) const override {
+			vec3 n = normalize(rec.normal);
+			double ndotwo = dot(n, wo);
+			double ndotwi = dot(n, wi);
+			if (ndotwo <= 0.0 || ndotwi <= 0.0) return 0.0;
+
+			// the visible normals have the density d*g1*hdotwo/ndotwo and
+			// the reflection maps them to directions with 1/(4*hdotwo)
+			vec3 h = normalize(wo + wi);
+			double d = normal_distribution_ggx(dot(n, h), m_roughness);
+			double specular = d * geometry_smith_ggx(ndotwo, m_roughness) / (4.0 * ndotwo);
+
+			return m_kd * cosine_hemisphere_pdf(ndotwi) + (1.0 - m_kd) * specular;
 		}
 
 	private:
@@ -82,29 +102,31 @@ namespace rt {
 		 * specifies the roughness of the surface.
 		 */
 		double normal_distribution_ggx(double ndoth, double a) const {
+			if (ndoth <= 0.0) return 0.0;
 			double a2 = a * a;
 			double d = (ndoth * (a2*ndoth - ndoth) + 1.0);
 
-			return saturate(a2 / (PI * d * d));
+			return a2 / (PI * d * d);
 		}
 
-
 		/**
-		 * schlick approximation of the smith equation
+		 * smith masking function of the ggx distribution, the fraction
+		 * of the microfacets that is visible from the direction v
 		 */
-		double geometry_schlick_ggx(double ndotv, double k) const {
-			return ndotv / (ndotv * (1.0 - k) + k);
+		double geometry_smith_ggx(double ndotv, double a) const {
+			double cos2 = ndotv * ndotv;
+			double tan2 = std::max(0.0, 1.0 - cos2) / cos2;
+			return 2.0 / (1.0 + std::sqrt(1.0 + a * a * tan2));
 		}
 
 		/**
 		 * specifies the geometric shadowing of the microfacets based
-		 * on the view vector and the roughness of the surface. here
-		 * k depends on the roughness of the surface. this implementation
-		 * uses the smith method.
+		 * on the view vector and the roughness of the surface. this
+		 * implementation uses the separable smith method.
 		 */
-		double geometry_smith(double ndotl, double ndotv, double k) const {
-			double ggx1 = geometry_schlick_ggx(ndotv, k);
-			double ggx2 = geometry_schlick_ggx(ndotl, k);
+		double geometry_smith(double ndotl, double ndotv, double a) const {
+			double ggx1 = geometry_smith_ggx(ndotv, a);
+			double ggx2 = geometry_smith_ggx(ndotl, a);
 
 			return ggx1 * ggx2;
 		}
@@ -115,7 +137,46 @@ namespace rt {
 		vec3 fresnel_schlick(double ldoth, vec3 f0) const {
 			return f0 + (vec3(1.0) - f0) * std::pow(1.0 - ldoth, 5.0);
 		}
+
+		/**
+		 * samples a microfacet normal proportional to its visible area
+		 * as seen from the viewer, after heitz "sampling the ggx
+		 * distribution of visible normals". the view direction is
+		 * stretched to a hemisphere configuration, in which the visible
+		 * normals are uniformly distributed over a projected disk
+		 * @param n - normalized surface normal
+		 * @param wo - normalized direction towards the viewer
+		 * @param u1 - first random number in [0,1)
+		 * @param u2 - second random number in [0,1)
+		 * @return normalized microfacet normal
+		 */
+		vec3 sample_visible_normal(const vec3& n, const vec3& wo, double u1, double u2) const {
+			vec3 t, b;
+			orthonormal_basis(n, t, b);
+
+			// view direction in the stretched hemisphere configuration
+			double alpha = m_roughness;
+			vec3 vh = normalize(vec3(alpha * dot(wo, t), alpha * dot(wo, b), dot(wo, n)));
+
+			// basis around the view direction
+			double lensq = vh.x * vh.x + vh.y * vh.y;
+			vec3 t1 = (lensq > 0.0) ? vec3(-vh.y, vh.x, 0) / std::sqrt(lensq) : vec3(1, 0, 0);
+			vec3 t2 = cross(vh, t1);
+
+			// point on the disk, the half hidden behind the hemisphere
+			// is squeezed onto the visible part
+			vec3 disk = concentric_disk(u1, u2);
+			double p1 = disk.x;
+			double p2 = disk.y;
+			double s = 0.5 * (1.0 + vh.z);
+			p2 = (1.0 - s) * std::sqrt(std::max(0.0, 1.0 - p1 * p1)) + s * p2;
+
+			// project onto the hemisphere and unstretch
+			vec3 nh = p1 * t1 + p2 * t2 + std::sqrt(std::max(0.0, 1.0 - p1 * p1 - p2 * p2)) * vh;
+			vec3 ne = normalize(vec3(alpha * nh.x, alpha * nh.y, std::max(0.0, double(nh.z))));
+			return normalize(ne.x * t + ne.y * b + ne.z * n);
+		}
 	};
 }
 
-#endif BRDF_H
\ No newline at end of file
+#endif//BRDF_H
\ No newline at end of file
@@ -19,7 +19,7 @@ namespace rt {
 			double cosine;
 			double reflectProb;
 		
-			vec3 refracted;
+			vec3 refracted(0);
 			if (dot(rIn.dir, rec.normal) > 0) {
 				outwardNormal = -rec.normal;
 				niOverNt = m_refractionidx;
@@ -29,6 +29,7 @@ namespace rt {
 		virtual vec3 emitted(float u, float v, const vec3& lp) const override { 
 			return m_emit->value(u, v, lp);
 		}
+		virtual bool is_emissive() const override { return true; }
 
 	private:
 		std::shared_ptr<ITexture> m_emit;
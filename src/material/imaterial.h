@@ -24,6 +24,37 @@ namespace rt {
 		 * @return color for the position (u,v)
 		 */
 		virtual vec3 emitted(float u, float v, const vec3& lp) const { return vec3(0); }
+		/**
+		 * checks if the material emits light, surfaces with such
+		 * a material are sampled explicitly as lights
+		 * @return true if the material emits light
+		 */
+		virtual bool is_emissive() const { return false; }
+
+		/**
+		 * checks if the material scatters into discrete directions. materials
+		 * that don't describe their scattering with eval() and pdf() count as
+		 * specular as well, lights are only sampled for non specular materials
+		 * @return true if the scattering can't be evaluated for arbitrary directions
+		 */
+		virtual bool is_specular() const { return true; }
+		/**
+		 * evaluates the scattering function times the cosine between the normal
+		 * and the incoming direction
+		 * @param rec - hit record of the surface
+		 * @param wo - normalized direction towards the viewer
+		 * @param wi - normalized direction towards the incoming light
+		 * @return fraction of the light from wi that is scattered into wo
+		 */
+		virtual vec3 eval(const HitRecord& /*rec*/, const vec3& /*wo*/, const vec3& /*wi*/) const { return vec3(0); }
+		/**
+		 * returns the density with which scatter() samples a direction
+		 * @param rec - hit record of the surface
+		 * @param wo - normalized direction towards the viewer
+		 * @param wi - normalized direction towards the incoming light
+		 * @return pdf w.r.t. solid angle
+		 */
+		virtual double pdf(const HitRecord& /*rec*/, const vec3& /*wo*/, const vec3& /*wi*/) const { return 0.0; }
 	};
 }
 
@@ -2,6 +2,7 @@
 #define ISOTROPIC_H
 
 #include "imaterial.h"
+#include "math/sampling.h"
 #include "texture/itexture.h"
 
 namespace rt {
@@ -10,7 +11,9 @@ namespace rt {
 		Isotropic(std::shared_ptr<ITexture> albedo) : m_albedo(albedo) {}
 
 		virtual bool scatter(const ray& rIn, const HitRecord& record, vec3& attenuation, ray& scattered) const {
-			scattered = ray(record.p, randomDir());
+			double u1 = drand();
+			double u2 = drand();
+			scattered = ray(record.p, uniform_sphere(u1, u2));
 			attenuation = m_albedo->value(record.u, record.v, record.lp);
 			return true;
 		}
@@ -2,6 +2,8 @@
 #define LAMBERTIAN_H
 
 #include "imaterial.h"
+#include "math/constants.h"
+#include "math/sampling.h"
 #include "texture/itexture.h"
 
 namespace rt {
@@ -10,12 +12,24 @@ namespace rt {
 		Lambertian(std::shared_ptr<ITexture> a) : m_albedo(a) {}
 
 		virtual bool scatter(const ray& rIn, const HitRecord& rec, vec3& attenuation, ray& scattered) const {
-			vec3 target = rec.p + rec.normal + randomDir();
-			scattered = ray(rec.p, target - rec.p);
+			double u1 = drand();
+			double u2 = drand();
+			scattered = ray(rec.p, cosine_direction(rec.normal, u1, u2));
 			attenuation = m_albedo->value(rec.u, rec.v, rec.lp);
 			return true;
 		}
 
+		virtual bool is_specular() const override { return false; }
+		virtual vec3 eval(const HitRecord& rec, const vec3& /*wo*/, const vec3& wi) const override {
+			double cosine = dot(rec.normal, wi);
+			if (cosine <= 0.0) return vec3(0);
+			return m_albedo->value(rec.u, rec.v, rec.lp) * (cosine / PI);
+		}
+		virtual double pdf(const HitRecord& rec, const vec3& /*wo*/, const vec3& wi) const override {
+			double cosine = dot(rec.normal, wi);
+			return cosine_hemisphere_pdf(cosine);
+		}
+
 	private:
 		std::shared_ptr<ITexture> m_albedo;
 	};
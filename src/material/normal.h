@@ -2,14 +2,16 @@
 #define NORMAL_MATERIAL_H
 
 #include "imaterial.h"
+#include "math/sampling.h"
 
 namespace rt {
 class NormalMaterial : public IMaterial {
 public:
 	NormalMaterial() {}
 	virtual bool scatter(const ray& rIn, const HitRecord& rec, vec3& attenuation, ray& scattered) const {
-		vec3 target = rec.p + rec.normal + randomDir();
-		scattered = ray(rec.p, normalize(target - rec.p));
+		double u1 = drand();
+		double u2 = drand();
+		scattered = ray(rec.p, cosine_direction(rec.normal, u1, u2));
 		attenuation = (rec.normal + vec3(1.f)) / 2.f;
 		return true;
 	}
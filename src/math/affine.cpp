@@ -0,0 +1,113 @@
+#include "affine.h"
+
+#include "constants.h"
+
+rt::affine::affine() {
+	for (size_t r = 0; r < 3; ++r) {
+		for (size_t c = 0; c < 4; ++c) {
+			m[r][c] = (r == c) ? 1.0 : 0.0;
+		}
+	}
+}
+
+rt::affine rt::affine::translation(const vec3& offset) {
+	affine a;
+	a.m[0][3] = offset.x;
+	a.m[1][3] = offset.y;
+	a.m[2][3] = offset.z;
+	return a;
+}
+
+rt::affine rt::affine::rotation(const vec3& axis, double angle) {
+	// rodrigues rotation formula in matrix form
+	vec3 k = normalize(axis);
+	double theta = angle * DEG_TO_RAD;
+	double c = std::cos(theta);
+	double s = std::sin(theta);
+	double t = 1.0 - c;
+
+	affine a;
+	a.m[0][0] = t * k.x * k.x + c;       a.m[0][1] = t * k.x * k.y - s * k.z; a.m[0][2] = t * k.x * k.z + s * k.y;
+	a.m[1][0] = t * k.x * k.y + s * k.z; a.m[1][1] = t * k.y * k.y + c;       a.m[1][2] = t * k.y * k.z - s * k.x;
+	a.m[2][0] = t * k.x * k.z - s * k.y; a.m[2][1] = t * k.y * k.z + s * k.x; a.m[2][2] = t * k.z * k.z + c;
+	return a;
+}
+
+rt::affine rt::affine::scaling(const vec3& factors) {
+	affine a;
+	a.m[0][0] = factors.x;
+	a.m[1][1] = factors.y;
+	a.m[2][2] = factors.z;
+	return a;
+}
+
+rt::affine rt::operator*(const affine& a, const affine& b) {
+	affine res;
+	for (size_t r = 0; r < 3; ++r) {
+		for (size_t c = 0; c < 4; ++c) {
+			double sum = (c == 3) ? a.m[r][3] : 0.0;
+			for (size_t k = 0; k < 3; ++k) sum += a.m[r][k] * b.m[k][c];
+			res.m[r][c] = sum;
+		}
+	}
+	return res;
+}
+
+rt::affine rt::inverse(const affine& a) {
+	// inverse of the linear part via the adjugate
+	const double (*m)[4] = a.m;
+	double det = m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1])
+	           - m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0])
+	           + m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
+	double invdet = 1.0 / det;
+
+	affine res;
+	res.m[0][0] =  (m[1][1] * m[2][2] - m[1][2] * m[2][1]) * invdet;
+	res.m[0][1] = -(m[0][1] * m[2][2] - m[0][2] * m[2][1]) * invdet;
+	res.m[0][2] =  (m[0][1] * m[1][2] - m[0][2] * m[1][1]) * invdet;
+	res.m[1][0] = -(m[1][0] * m[2][2] - m[1][2] * m[2][0]) * invdet;
+	res.m[1][1] =  (m[0][0] * m[2][2] - m[0][2] * m[2][0]) * invdet;
+	res.m[1][2] = -(m[0][0] * m[1][2] - m[0][2] * m[1][0]) * invdet;
+	res.m[2][0] =  (m[1][0] * m[2][1] - m[1][1] * m[2][0]) * invdet;
+	res.m[2][1] = -(m[0][0] * m[2][1] - m[0][1] * m[2][0]) * invdet;
+	res.m[2][2] =  (m[0][0] * m[1][1] - m[0][1] * m[1][0]) * invdet;
+
+	// the inverse translation is the negated translation transformed by the inverse
+	for (size_t r = 0; r < 3; ++r) {
+		res.m[r][3] = -(res.m[r][0] * m[0][3] + res.m[r][1] * m[1][3] + res.m[r][2] * m[2][3]);
+	}
+	return res;
+}
+
+rt::vec3 rt::transform_point(const affine& a, const vec3& p) {
+	return vec3(a.m[0][0] * p.x + a.m[0][1] * p.y + a.m[0][2] * p.z + a.m[0][3],
+	            a.m[1][0] * p.x + a.m[1][1] * p.y + a.m[1][2] * p.z + a.m[1][3],
+	            a.m[2][0] * p.x + a.m[2][1] * p.y + a.m[2][2] * p.z + a.m[2][3]);
+}
+
+rt::vec3 rt::transform_vector(const affine& a, const vec3& v) {
+	return vec3(a.m[0][0] * v.x + a.m[0][1] * v.y + a.m[0][2] * v.z,
+	            a.m[1][0] * v.x + a.m[1][1] * v.y + a.m[1][2] * v.z,
+	            a.m[2][0] * v.x + a.m[2][1] * v.y + a.m[2][2] * v.z);
+}
+
+rt::vec3 rt::transform_normal(const affine& inverse, const vec3& n) {
+	return vec3(inverse.m[0][0] * n.x + inverse.m[1][0] * n.y + inverse.m[2][0] * n.z,
+	            inverse.m[0][1] * n.x + inverse.m[1][1] * n.y + inverse.m[2][1] * n.z,
+	            inverse.m[0][2] * n.x + inverse.m[1][2] * n.y + inverse.m[2][2] * n.z);
+}
+
+rt::aabb rt::transform_box(const affine& a, const aabb& box) {
+	// the transformed box is spanned by the transformed corners
+	aabb res;
+	for (size_t z = 0; z < 2; ++z) {
+		for (size_t y = 0; y < 2; ++y) {
+			for (size_t x = 0; x < 2; ++x) {
+				vec3 alpha(x, y, z);
+				vec3 p = alpha * box.max() + (vec3(1) - alpha) * box.min();
+				res.extend(transform_point(a, p));
+			}
+		}
+	}
+	return res;
+}
\ No newline at end of file
@@ -0,0 +1,74 @@
+#ifndef AFFINE_H
+#define AFFINE_H
+
+#include "spatial/aabb.h"
+#include "vec3.h"
+
+namespace rt {
+	/**
+	 * affine transformation stored as 3x4 matrix. the first three
+	 * columns hold the linear part and the last column the translation
+	 */
+	class affine {
+	public:
+		/**
+		 * empty transformation is initialized as identity
+		 */
+		affine();
+
+		/**
+		 * creates a translation by the specified offset
+		 * @param offset - direction and distance of the translation
+		 */
+		static affine translation(const vec3& offset);
+		/**
+		 * creates a counter-clockwise rotation around an axis
+		 * @param axis - axis of rotation, doesn't need to be normalized
+		 * @param angle - angle in degrees
+		 */
+		static affine rotation(const vec3& axis, double angle);
+		/**
+		 * creates a scaling along the coordinate axes
+		 * @param factors - scaling factor per axis, none of them may be zero
+		 */
+		static affine scaling(const vec3& factors);
+
+		/**
+		 * [] operator for accessing the rows
+		 */
+		double* operator[](int i) { return m[i]; }
+		const double* operator[](int i) const { return m[i]; }
+
+		double m[3][4];
+	};
+
+	/**
+	 * concatenates two transformations, b is applied first
+	 */
+	affine operator*(const affine& a, const affine& b);
+	/**
+	 * calculates the inverse of a transformation
+	 * the linear part has to be invertible
+	 */
+	affine inverse(const affine& a);
+	/**
+	 * transforms a point, the translation is applied
+	 */
+	vec3 transform_point(const affine& a, const vec3& p);
+	/**
+	 * transforms a direction, the translation is ignored
+	 */
+	vec3 transform_vector(const affine& a, const vec3& v);
+	/**
+	 * transforms a normal with the transposed inverse
+	 * @param inverse - inverse of the transformation that is applied to the normal
+	 * @param n - normal to transform, the result is not normalized
+	 */
+	vec3 transform_normal(const affine& inverse, const vec3& n);
+	/**
+	 * calculates the bounding box of a transformed box
+	 */
+	aabb transform_box(const affine& a, const aabb& box);
+}
+
+#endif//AFFINE_H
\ No newline at end of file
@@ -1,6 +1,7 @@
 #ifndef ALGORITHM_H
 #define ALGORITHM_H
 
+#include <algorithm>
 #include <random>
 
 #include "constants.h"
@@ -8,6 +9,7 @@
 namespace rt {
 	/**
 	 * returns a random floating point number in the range [0,1)
+	 * drawn from the sampler of the calling thread
 	 * @return random number
 	 */
 	double drand();
@@ -28,14 +30,18 @@ namespace rt {
 	 * @return true if val is in the range ]vmin, vmax[
 	 * and false otherwise
 	 */
-	bool is_between(double val, double vmin, double vmax);
+	constexpr bool is_between(double val, double vmin, double vmax) {
+		return vmin < val && val < vmax;
+	}
 
 	/**
 	 * bounds the value to the range [0, 1]
 	 * @param val - the value to bound
 	 * @return value or 0 or 1 is val is out of bounds
 	 */
-	double saturate(double val);
+	constexpr real saturate(real val) {
+		return std::min(std::max(val, real(0)), real(1));
+	}
 }
 
 #endif//ALGORITHM_H
\ No newline at end of file
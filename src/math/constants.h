@@ -2,6 +2,16 @@
 #define CONSTANTS_H
 
 namespace rt {
+	/**
+	 * scalar type of the vector math, single precision is
+	 * selected at compile time by defining RT_SINGLE_PRECISION
+	 */
+#if defined(RT_SINGLE_PRECISION)
+	using real = float;
+#else
+	using real = double;
+#endif
+
 	const double PI = 3.141592653589;
 	const double TWO_PI = 2 * PI;
 	const double HALF_PI = 0.5 * PI;
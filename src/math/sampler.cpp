@@ -0,0 +1,31 @@
+#include "sampler.h"
+
+namespace {
+	/**
+	 * splitmix64 finalizer that scrambles nearby inputs
+	 * into unrelated seeds
+	 */
+	uint64_t mix(uint64_t x) {
+		x += 0x9e3779b97f4a7c15ULL;
+		x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+		x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+		return x ^ (x >> 31);
+	}
+}
+
+void rt::Sampler::start_sample(uint64_t pixel, uint64_t sample) {
+	m_pixel = pixel;
+	m_sample = sample;
+	start_bounce(0);
+}
+
+void rt::Sampler::start_bounce(uint32_t bounce) {
+	// the seed selects the sample and the stream selects the bounce
+	uint64_t seed = mix(mix(m_pixel) ^ m_sample);
+	m_generator.seed(seed, bounce);
+}
+
+rt::Sampler& rt::sampler() {
+	thread_local Sampler threadsampler;
+	return threadsampler;
+}
\ No newline at end of file
@@ -0,0 +1,95 @@
+#ifndef SAMPLER_H
+#define SAMPLER_H
+
+#include <cstdint>
+
+namespace rt {
+	/**
+	 * pcg32 random number generator by Melissa O'Neill. it has 64 bits
+	 * of state, a selectable stream and passes the usual statistical
+	 * test suites while being cheaper than std::mt19937
+	 */
+	class PCG32 {
+	public:
+		PCG32() { seed(0x853c49e6748fea9bULL, 0xda3e39cb94b95bdbULL); }
+		PCG32(uint64_t initstate, uint64_t initseq) { seed(initstate, initseq); }
+
+		/**
+		 * resets the state of the generator
+		 * @param initstate - starting state
+		 * @param initseq - index of the stream
+		 */
+		void seed(uint64_t initstate, uint64_t initseq) {
+			m_state = 0u;
+			m_inc = (initseq << 1u) | 1u;
+			next_uint();
+			m_state += initstate;
+			next_uint();
+		}
+
+		/**
+		 * returns a uniformly distributed 32 bit integer
+		 * @return random number
+		 */
+		uint32_t next_uint() {
+			uint64_t oldstate = m_state;
+			m_state = oldstate * 6364136223846793005ULL + m_inc;
+			uint32_t xorshifted = static_cast<uint32_t>(((oldstate >> 18u) ^ oldstate) >> 27u);
+			uint32_t rot = static_cast<uint32_t>(oldstate >> 59u);
+			return (xorshifted >> rot) | (xorshifted << ((~rot + 1u) & 31));
+		}
+
+		/**
+		 * returns a uniformly distributed floating point number in [0,1)
+		 * @return random number
+		 */
+		double next_double() {
+			return static_cast<double>(next_uint()) * (1.0 / 4294967296.0);
+		}
+
+	private:
+		uint64_t m_state;
+		uint64_t m_inc;
+	};
+
+	/**
+	 * provides the random numbers of one thread. the sequence of random
+	 * numbers only depends on the pixel, the sample index and the bounce
+	 * it was seeded for. thus renders are reproducible regardless of the
+	 * number of threads and the order in which tiles are rendered
+	 */
+	class Sampler {
+	public:
+		Sampler() : m_pixel(0), m_sample(0) {}
+
+		/**
+		 * starts the random sequence of a new camera sample
+		 * @param pixel - linear index of the pixel
+		 * @param sample - index of the sample within the pixel
+		 */
+		void start_sample(uint64_t pixel, uint64_t sample);
+		/**
+		 * starts the random sequence of a bounce of the current sample
+		 * @param bounce - number of the bounce, 0 is the camera ray
+		 */
+		void start_bounce(uint32_t bounce);
+
+		/**
+		 * returns a uniformly distributed floating point number in [0,1)
+		 * @return random number
+		 */
+		double next_double() { return m_generator.next_double(); }
+
+	private:
+		PCG32    m_generator;
+		uint64_t m_pixel, m_sample;
+	};
+
+	/**
+	 * returns the sampler of the calling thread
+	 * @return thread local sampler
+	 */
+	Sampler& sampler();
+}
+
+#endif//SAMPLER_H
\ No newline at end of file
@@ -0,0 +1,156 @@
+#ifndef SAMPLING_H
+#define SAMPLING_H
+
+#include <algorithm>
+#include <cmath>
+
+#include "constants.h"
+#include "vec3.h"
+
+namespace rt {
+	/**
+	 * closed form warps of the unit square onto the domains that are
+	 * sampled by the materials, lights and cameras. the random numbers
+	 * are passed in explicitly, thus neighboring inputs stay close
+	 * after the warp and stratified samples keep their stratification
+	 */
+
+	/**
+	 * builds an orthonormal basis around a direction without branches
+	 * or square roots, after duff et al. "building an orthonormal basis,
+	 * revisited"
+	 * @param n - normalized direction, the third axis of the basis
+	 * @param t - first tangent
+	 * @param b - second tangent
+	 */
+	inline void orthonormal_basis(const vec3& n, vec3& t, vec3& b) {
+		double sign = std::copysign(1.0, double(n.z));
+		double a = -1.0 / (sign + n.z);
+		double c = n.x * n.y * a;
+		t = vec3(1.0 + sign * n.x * n.x * a, sign * c, -sign * n.x);
+		b = vec3(c, sign + n.y * n.y * a, -n.y);
+	}
+
+	/**
+	 * maps the unit square onto the unit disk with shirley's concentric
+	 * mapping, which keeps the relative areas and distorts less than
+	 * the polar mapping
+	 * @param u1 - first random number in [0,1)
+	 * @param u2 - second random number in [0,1)
+	 * @return point in the xy-plane with a length below 1
+	 */
+	inline vec3 concentric_disk(double u1, double u2) {
+		double x = 2.0 * u1 - 1.0;
+		double y = 2.0 * u2 - 1.0;
+		if (x == 0.0 && y == 0.0) return vec3(0);
+
+		double r, phi;
+		if (std::fabs(x) > std::fabs(y)) {
+			r = x;
+			phi = 0.25 * PI * (y / x);
+		}
+		else {
+			r = y;
+			phi = HALF_PI - 0.25 * PI * (x / y);
+		}
+		return vec3(r * std::cos(phi), r * std::sin(phi), 0);
+	}
+
+	/**
+	 * samples a direction of the hemisphere around the z-axis with a density
+	 * proportional to the cosine, by projecting a point of the disk up
+	 * @param u1 - first random number in [0,1)
+	 * @param u2 - second random number in [0,1)
+	 * @return normalized direction with z >= 0
+	 */
+	inline vec3 cosine_hemisphere(double u1, double u2) {
+		vec3 d = concentric_disk(u1, u2);
+		d.z = std::sqrt(std::max<double>(0.0, 1.0 - d.x * d.x - d.y * d.y));
+		return d;
+	}
+	/**
+	 * density of cosine_hemisphere() w.r.t. solid angle
+	 * @param cosine - cosine between the direction and the axis
+	 * @return pdf of the direction
+	 */
+	inline double cosine_hemisphere_pdf(double cosine) {
+		return (cosine <= 0.0) ? 0.0 : cosine / PI;
+	}
+
+	/**
+	 * samples a direction in the hemisphere around the normal with a
+	 * density proportional to the cosine, which is cosine/pi
+	 * @param normal - normalized axis of the hemisphere
+	 * @param u1 - first random number in [0,1)
+	 * @param u2 - second random number in [0,1)
+	 * @return normalized direction
+	 */
+	inline vec3 cosine_direction(const vec3& normal, double u1, double u2) {
+		vec3 t, b;
+		orthonormal_basis(normal, t, b);
+		vec3 d = cosine_hemisphere(u1, u2);
+		return d.x * t + d.y * b + d.z * normal;
+	}
+
+	/**
+	 * samples a direction uniformly over the whole sphere
+	 * @param u1 - first random number in [0,1)
+	 * @param u2 - second random number in [0,1)
+	 * @return normalized direction
+	 */
+	inline vec3 uniform_sphere(double u1, double u2) {
+		double z = 1.0 - 2.0 * u1;
+		double r = std::sqrt(std::max(0.0, 1.0 - z * z));
+		double phi = TWO_PI * u2;
+		return vec3(r * std::cos(phi), r * std::sin(phi), z);
+	}
+	/**
+	 * density of uniform_sphere() w.r.t. solid angle
+	 * @return pdf of every direction
+	 */
+	inline double uniform_sphere_pdf() {
+		return 1.0 / (2.0 * TWO_PI);
+	}
+
+	/**
+	 * samples a direction uniformly within a cap of the sphere around the
+	 * z-axis. the cap is given by its height 1-cos(theta max), which the
+	 * caller can compute accurately for narrow caps
+	 * @param u1 - first random number in [0,1)
+	 * @param u2 - second random number in [0,1)
+	 * @param height - height of the cap on the unit sphere in (0,2]
+	 * @return normalized direction
+	 */
+	inline vec3 sphere_cap(double u1, double u2, double height) {
+		// 1-z^2 = (1-z)(1+z) doesn't cancel for narrow caps
+		double h = u1 * height;
+		double r = std::sqrt(std::max(0.0, h * (2.0 - h)));
+		double z = 1.0 - h;
+		double phi = TWO_PI * u2;
+		return vec3(r * std::cos(phi), r * std::sin(phi), z);
+	}
+	/**
+	 * density of sphere_cap() w.r.t. solid angle
+	 * @param height - height of the cap on the unit sphere
+	 * @return pdf of every direction within the cap
+	 */
+	inline double sphere_cap_pdf(double height) {
+		return 1.0 / (TWO_PI * height);
+	}
+
+	/**
+	 * samples uniformly distributed barycentric coordinates of a triangle,
+	 * the weights of the corners p1, p2 and p3 are (1-b1-b2), b1 and b2
+	 * @param u1 - first random number in [0,1)
+	 * @param u2 - second random number in [0,1)
+	 * @param b1 - second barycentric coordinate
+	 * @param b2 - third barycentric coordinate
+	 */
+	inline void uniform_triangle(double u1, double u2, double& b1, double& b2) {
+		double su = std::sqrt(u1);
+		b1 = u2 * su;
+		b2 = 1.0 - su;
+	}
+}
+
+#endif//SAMPLING_H
\ No newline at end of file
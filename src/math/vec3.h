@@ -1,16 +1,22 @@
 #ifndef VEC3_H
 #define VEC3_H
 
-#include <math.h>
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 
 #include "algorithm.h"
 
 namespace rt {
+	/**
+	 * three component vector of the scalar type real. all functions are
+	 * defined in the header so that they get inlined in every translation
+	 * unit, the arithmetic ones are constexpr
+	 */
 	class vec3 {
 	public:
 		/**
-		 * empty vector is initialized as zero vector (0,0,0)
+		 * empty vector is left uninitialized
 		 */
 		vec3() {};
 		/**
@@ -18,149 +24,185 @@ namespace rt {
 		 * components (e012,e012,e012)
 		 * @param e012 - value used for all three parameters
 		 */
-		vec3(double e012) { e[0] = e012; e[1] = e012; e[2] = e012; }
+		constexpr vec3(real e012) : e{ e012, e012, e012 } { }
 		/**
 		 * constructor with three parameters
 		 * @param e0 - first component
 		 * @param e1 - first component
 		 * @param e2 - first component
 		 */
-		vec3(double e0, double e1, double e2) { e[0] = e0; e[1] = e1; e[2] = e2; }
+		constexpr vec3(real e0, real e1, real e2) : e{ e0, e1, e2 } { }
 
 		/**
 		 * + operator before vector does nothing
 		 */
-		const vec3& operator+() const { return *this; }
+		constexpr const vec3& operator+() const { return *this; }
 		/**
 		 * - operator before vector inverts its components
 		 */
-		vec3 operator-() const { return vec3(-e[0], -e[1], -e[2]); }
+		constexpr vec3 operator-() const { return vec3(-e[0], -e[1], -e[2]); }
 		/**
 		 * [] operator for accessing components
 		 */
-		double operator[](int i) const { return e[i]; }
+		constexpr real operator[](int i) const { return e[i]; }
 
 		/**
 		 * handy operators for vector math
 		 */
-		vec3& operator+=(const vec3&  v);
-		vec3& operator-=(const vec3&  v);
-		vec3& operator*=(const vec3&  v);
-		vec3& operator/=(const vec3&  v);
-		vec3& operator*=(const double t);
-		vec3& operator/=(const double t);
+		constexpr vec3& operator+=(const vec3& v) { e[0] += v.e[0]; e[1] += v.e[1]; e[2] += v.e[2]; return *this; }
+		constexpr vec3& operator-=(const vec3& v) { e[0] -= v.e[0]; e[1] -= v.e[1]; e[2] -= v.e[2]; return *this; }
+		constexpr vec3& operator*=(const vec3& v) { e[0] *= v.e[0]; e[1] *= v.e[1]; e[2] *= v.e[2]; return *this; }
+		constexpr vec3& operator/=(const vec3& v) { e[0] /= v.e[0]; e[1] /= v.e[1]; e[2] /= v.e[2]; return *this; }
+		constexpr vec3& operator*=(const real t)  { e[0] *= t; e[1] *= t; e[2] *= t; return *this; }
+		constexpr vec3& operator/=(const real t)  { e[0] /= t; e[1] /= t; e[2] /= t; return *this; }
 
 		/**
 		 * calculates the euclidean norm sqrt(x^2+y^2+z^2)
 		 * @return euclidean norm
 		 */
-		double length() const;
+		real length() const { return std::sqrt(length2()); }
 		/**
 		 * calculates the squared euclidean norm ||x^2+y^2+z^2||
 		 * @return squared euclidean norm
 		 */
-		double length2() const;
+		constexpr real length2() const { return e[0] * e[0] + e[1] * e[1] + e[2] * e[2]; }
 		/**
 		 * normalizes the length of the vector to size 1
 		 */
-		void normalize();
+		void normalize() { *this *= real(1) / length(); }
 
 		/**
 		 * union hack to make it possible to consistently
 		 * update vector members
 		 */
 		union {
-			double e[3];
-			struct { double x, y, z; };
-			struct { double r, g, b; };
-			struct { double s, t, p; };
+			real e[3];
+			struct { real x, y, z; };
+			struct { real r, g, b; };
+			struct { real s, t, p; };
 		};
 	};
 
 	/**
 	 * handy binary operators for vector math
 	 */
-	vec3 operator+(const vec3& v1, const vec3& v2);
-	vec3 operator-(const vec3& v1, const vec3& v2);
-	vec3 operator*(const vec3& v1, const vec3& v2);
-	vec3 operator/(const vec3& v1, const vec3& v2);
-	vec3 operator*(double       t, const vec3&  v);
-	vec3 operator/(const vec3&  v, double       t);
-	vec3 operator*(const vec3&  v, double       t);
+	constexpr vec3 operator+(const vec3& v1, const vec3& v2) { return vec3(v1.e[0] + v2.e[0], v1.e[1] + v2.e[1], v1.e[2] + v2.e[2]); }
+	constexpr vec3 operator-(const vec3& v1, const vec3& v2) { return vec3(v1.e[0] - v2.e[0], v1.e[1] - v2.e[1], v1.e[2] - v2.e[2]); }
+	constexpr vec3 operator*(const vec3& v1, const vec3& v2) { return vec3(v1.e[0] * v2.e[0], v1.e[1] * v2.e[1], v1.e[2] * v2.e[2]); }
+	constexpr vec3 operator/(const vec3& v1, const vec3& v2) { return vec3(v1.e[0] / v2.e[0], v1.e[1] / v2.e[1], v1.e[2] / v2.e[2]); }
+	constexpr vec3 operator*(real         t, const vec3&  v) { return vec3(t * v.e[0], t * v.e[1], t * v.e[2]); }
+	constexpr vec3 operator/(const vec3&  v, real         t) { return vec3(v.e[0] / t, v.e[1] / t, v.e[2] / t); }
+	constexpr vec3 operator*(const vec3&  v, real         t) { return vec3(t * v.e[0], t * v.e[1], t * v.e[2]); }
 
 	/**
 	 * add support for printing the vector
 	 */
-	std::ostream& operator<<(std::ostream& os, const vec3& v);
+	inline std::ostream& operator<<(std::ostream& os, const vec3& v) {
+		os << "(" << v.x << "," << v.y << "," << v.z << ")";
+		return os;
+	}
 
 	/**
-	 * return a unit vector with a random directory
+	 * performs a dot product between two vectors v1 and v2
 	 */
-	vec3 randomDir();
+	constexpr real dot(const vec3 &v1, const vec3 &v2) {
+		return v1.e[0] * v2.e[0] + v1.e[1] * v2.e[1] + v1.e[2] * v2.e[2];
+	}
+	/**
+	 * performs a cross product between two vectors v1 and v2
+	 */
+	constexpr vec3 cross(const vec3 &v1, const vec3 &v2) {
+		return vec3(
+			(v1.e[1] * v2.e[2] - v1.e[2] * v2.e[1]),
+			(-(v1.e[0] * v2.e[2] - v1.e[2] * v2.e[0])),
+			(v1.e[0] * v2.e[1] - v1.e[1] * v2.e[0])
+		);
+	}
 	/**
 	 * calculates the euclidean norm sqrt(x^2+y^2+z^2)
 	 * @return euclidean norm
 	 */
-	float length(const vec3& v);
+	inline real length(const vec3& v) { return v.length(); }
 	/**
 	 * normalizes the length of the vector to size 1
 	 */
-	vec3 normalize(const vec3 &v);
+	inline vec3 normalize(const vec3 &v) { return v / v.length(); }
 	/**
 	 * calculates a normal from three points
 	 */
-	vec3 normal(const vec3& p1, const vec3& p2, const vec3& p3);
-	/**
-	 * performs a dot product between two vectors v1 and v2
-	 */
-	double dot(const vec3 &v1, const vec3 &v2);
-	/**
-	 * performs a cross product between two vectors v1 and v2
-	 */
-	vec3 cross(const vec3 &v1, const vec3 &v2);
+	inline vec3 normal(const vec3& p1, const vec3& p2, const vec3& p3) {
+		vec3 v1 = normalize(p2 - p1);
+		vec3 v2 = normalize(p3 - p1);
+		return cross(v1, v2);
+	}
 	/**
 	 * reflects a vector v with respect to normal n
 	 * the vector v has to point towards the normal
 	 */
-	vec3 reflect(const vec3& v, const vec3& n);
+	constexpr vec3 reflect(const vec3& v, const vec3& n) {
+		return v - real(2) * dot(v, n) * n;
+	}
 	/**
 	 * refracts a vector v with respect to normal n
 	 * the vector v has to point towards the normal
 	 * niOverNt is the refraction coefficient
 	 * and refract is the result of refraction
 	 */
-	bool refract(const vec3& v, const vec3& n, double niOverNt, vec3& refracted);
+	inline bool refract(const vec3& v, const vec3& n, real niOverNt, vec3& refracted) {
+		vec3 uv = normalize(v);
+		real dt = dot(uv, n);
+		real discriminant = real(1) - niOverNt * niOverNt * (real(1) - dt * dt);
+
+		if (discriminant > 0) {
+			refracted = niOverNt * (uv - n * dt) - n * std::sqrt(discriminant);
+			return true;
+		}
+		else return false;
+	}
 
 	/**
 	 * performs a linear interpolation between two vectors v1 and v2
 	 * with regards to t with the formula (1-t)*v1 + t*v2
 	 */
-	vec3 lerp(const vec3& v1, const vec3& v2, double t);
+	constexpr vec3 lerp(const vec3& v1, const vec3& v2, real t) {
+		return (real(1) - t) * v1 + t * v2;
+	}
 	/** 
 	 * returns the componentwise minima of two vectors v1 and v2
 	 */
-	vec3 min(const vec3& v1, const vec3& v2);
+	constexpr vec3 min(const vec3& v1, const vec3& v2) {
+		return vec3(std::min(v1.e[0], v2.e[0]), std::min(v1.e[1], v2.e[1]), std::min(v1.e[2], v2.e[2]));
+	}
 	/**
 	 * returns the componentwise maxima of two vectors v1 and v2
 	 */
-	vec3 max(const vec3& v1, const vec3& v2);
+	constexpr vec3 max(const vec3& v1, const vec3& v2) {
+		return vec3(std::max(v1.e[0], v2.e[0]), std::max(v1.e[1], v2.e[1]), std::max(v1.e[2], v2.e[2]));
+	}
 	/**
 	 * returns the smallest component of vector v
 	 */
-	double min_comp(const vec3& v);
+	constexpr real min_comp(const vec3& v) {
+		return std::min(v.e[0], std::min(v.e[1], v.e[2]));
+	}
 	/**
 	 * returns the biggest component of vector v
 	 */
-	double max_comp(const vec3& v);
+	constexpr real max_comp(const vec3& v) {
+		return std::max(v.e[0], std::max(v.e[1], v.e[2]));
+	}
 	/**
 	 * performs a component wise square root
-	 * with regards to t with the formula (1-t)*v1 + t*v2
 	 */
-	vec3 sqrt(const vec3& v);
+	inline vec3 sqrt(const vec3& v) {
+		return vec3(std::sqrt(v.e[0]), std::sqrt(v.e[1]), std::sqrt(v.e[2]));
+	}
 	/**
 	 * clamps all components to (0,1)
 	 */
-	vec3 saturate(const vec3& v);
+	constexpr vec3 saturate(const vec3& v) {
+		return vec3(saturate(v.e[0]), saturate(v.e[1]), saturate(v.e[2]));
+	}
 }
 
 #endif//VEC3_H
\ No newline at end of file
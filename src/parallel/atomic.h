@@ -0,0 +1,19 @@
+#ifndef ATOMIC_H
+#define ATOMIC_H
+
+#include <atomic>
+
+namespace rt {
+	/**
+	 * adds a value to an atomic floating point number. std::atomic only
+	 * provides fetch_add for floating point types since c++20
+	 * @param a - number to add to
+	 * @param value - value to add
+	 */
+	inline void atomic_add(std::atomic<double>& a, double value) {
+		double expected = a.load(std::memory_order_relaxed);
+		while (!a.compare_exchange_weak(expected, expected + value, std::memory_order_relaxed));
+	}
+}
+
+#endif//ATOMIC_H
\ No newline at end of file
@@ -0,0 +1,8 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include "atomic.h"
+#include "threadpool.h"
+#include "tiles.h"
+
+#endif//PARALLEL_H
\ No newline at end of file
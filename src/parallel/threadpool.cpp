@@ -0,0 +1,163 @@
+#include "threadpool.h"
+
+namespace {
+	// identifies the pool and the queue that belong to the current thread
+	thread_local const rt::ThreadPool* t_pool = nullptr;
+	thread_local size_t t_queue = 0;
+
+	std::unique_ptr<rt::ThreadPool> g_pool;
+	std::mutex g_poolmutex;
+}
+
+rt::ThreadPool::ThreadPool(size_t threads) : m_queued(0), m_stop(false) {
+	// use all hardware threads by default
+	if (threads == 0) threads = std::thread::hardware_concurrency();
+	if (threads == 0) threads = 1;
+
+	// queue 0 belongs to the thread that waits on the pool
+	for (size_t i = 0; i < threads; ++i) {
+		m_queues.push_back(std::make_unique<Queue>());
+	}
+	for (size_t i = 1; i < threads; ++i) {
+		m_workers.emplace_back(&ThreadPool::work, this, i);
+	}
+}
+
+rt::ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> lock(m_sleepmutex);
+		m_stop = true;
+	}
+	m_wakeup.notify_all();
+	for (auto& worker : m_workers) worker.join();
+}
+
+void rt::ThreadPool::run(TaskGroup& group, std::function<void()> task) {
+	group.m_pending.fetch_add(1);
+	push(current_queue(), Task{ std::move(task), &group });
+}
+
+void rt::ThreadPool::wait(TaskGroup& group) {
+	size_t queue = current_queue();
+	while (group.m_pending.load() > 0) {
+		Task task;
+		if (next(queue, task)) {
+			execute(task);
+			continue;
+		}
+
+		// sleep until the group has finished or there is new work to help with
+		std::unique_lock<std::mutex> lock(m_sleepmutex);
+		m_wakeup.wait(lock, [this, &group]() { return group.m_pending.load() == 0 || m_queued.load() > 0; });
+	}
+}
+
+void rt::ThreadPool::parallel_for(size_t count, const std::function<void(size_t)>& body) {
+	TaskGroup group;
+	group.m_pending.fetch_add(count);
+
+	// distribute the indices among all queues
+	for (size_t i = 0; i < count; ++i) {
+		push(i % m_queues.size(), Task{ [&body, i]() { body(i); }, &group });
+	}
+
+	wait(group);
+}
+
+void rt::ThreadPool::push(size_t queue, Task task) {
+	{
+		std::lock_guard<std::mutex> lock(m_queues[queue]->mutex);
+		m_queues[queue]->tasks.push_back(std::move(task));
+	}
+	m_queued.fetch_add(1);
+
+	// lock to make sure a worker that is about to sleep sees the new task
+	{ std::lock_guard<std::mutex> lock(m_sleepmutex); }
+	m_wakeup.notify_one();
+}
+
+bool rt::ThreadPool::pop(size_t queue, Task& task) {
+	std::lock_guard<std::mutex> lock(m_queues[queue]->mutex);
+	auto& tasks = m_queues[queue]->tasks;
+	if (tasks.empty()) return false;
+
+	// newest task first, its data is most likely still in the cache
+	task = std::move(tasks.back());
+	tasks.pop_back();
+	return true;
+}
+
+bool rt::ThreadPool::steal(size_t queue, Task& task) {
+	for (size_t i = 1; i < m_queues.size(); ++i) {
+		size_t victim = (queue + i) % m_queues.size();
+		std::lock_guard<std::mutex> lock(m_queues[victim]->mutex);
+		auto& tasks = m_queues[victim]->tasks;
+		if (tasks.empty()) continue;
+
+		// oldest task of the victim, usually the biggest chunk of work
+		task = std::move(tasks.front());
+		tasks.pop_front();
+		return true;
+	}
+
+	return false;
+}
+
+bool rt::ThreadPool::next(size_t queue, Task& task) {
+	if (m_queued.load() == 0) return false;
+	if (pop(queue, task) || steal(queue, task)) {
+		m_queued.fetch_sub(1);
+		return true;
+	}
+
+	return false;
+}
+
+void rt::ThreadPool::execute(Task& task) {
+	task.function();
+
+	// wake the threads waiting on the group once its last task has finished,
+	// the group must not be touched afterwards since wait() may return
+	if (task.group->m_pending.fetch_sub(1) == 1) {
+		{ std::lock_guard<std::mutex> lock(m_sleepmutex); }
+		m_wakeup.notify_all();
+	}
+}
+
+void rt::ThreadPool::work(size_t queue) {
+	t_pool = this;
+	t_queue = queue;
+
+	while (true) {
+		Task task;
+		if (next(queue, task)) {
+			execute(task);
+			continue;
+		}
+
+		// sleep until there is new work or the pool shuts down
+		std::unique_lock<std::mutex> lock(m_sleepmutex);
+		m_wakeup.wait(lock, [this]() { return m_stop.load() || m_queued.load() > 0; });
+		if (m_stop.load() && m_queued.load() == 0) return;
+	}
+}
+
+size_t rt::ThreadPool::current_queue() const {
+	return (t_pool == this) ? t_queue : 0;
+}
+
+rt::ThreadPool& rt::thread_pool() {
+	std::lock_guard<std::mutex> lock(g_poolmutex);
+	if (g_pool == nullptr) g_pool = std::make_unique<ThreadPool>();
+	return *g_pool;
+}
+
+void rt::set_thread_count(size_t threads) {
+	std::lock_guard<std::mutex> lock(g_poolmutex);
+	size_t hardware = std::thread::hardware_concurrency();
+	size_t wanted = (threads == 0) ? ((hardware == 0) ? 1 : hardware) : threads;
+	if (g_pool != nullptr && g_pool->size() == wanted) return;
+
+	g_pool.reset();
+	g_pool = std::make_unique<ThreadPool>(wanted);
+}
\ No newline at end of file
@@ -0,0 +1,114 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace rt {
+	/**
+	 * a group of tasks that can be waited on as a whole
+	 */
+	class TaskGroup {
+	public:
+		TaskGroup() : m_pending(0) {}
+
+	private:
+		friend class ThreadPool;
+		std::atomic<size_t> m_pending;
+	};
+
+	/**
+	 * pool of worker threads with one task queue per thread. a thread
+	 * pops tasks from the back of its own queue and steals tasks from
+	 * the front of the other queues once its own queue runs empty. the
+	 * thread calling wait() takes part in the work, thus a pool of size
+	 * n spawns n-1 worker threads.
+	 */
+	class ThreadPool {
+	public:
+		/**
+		 * creates a pool with the specified number of threads
+		 * @param threads - number of threads, 0 uses all hardware threads
+		 */
+		ThreadPool(size_t threads = 0);
+		~ThreadPool();
+
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+		/**
+		 * returns the number of threads working on tasks
+		 * @return number of threads including the waiting thread
+		 */
+		size_t size() const { return m_queues.size(); }
+
+		/**
+		 * schedules a task as part of the specified group. tasks scheduled
+		 * from within a task end up in the queue of the current thread
+		 * @param group - group the task belongs to
+		 * @param task - function to execute
+		 */
+		void run(TaskGroup& group, std::function<void()> task);
+		/**
+		 * blocks until all tasks of the group have finished. the calling
+		 * thread executes and steals pending tasks in the meantime and
+		 * sleeps while there are none, thus it is safe to wait from
+		 * within a task
+		 * @param group - group to wait for
+		 */
+		void wait(TaskGroup& group);
+		/**
+		 * calls body for all indices in [0, count) and returns once all
+		 * calls have finished. the indices are distributed round robin
+		 * among the queues and get rebalanced by work stealing
+		 * @param count - number of indices
+		 * @param body - function that is called for each index
+		 */
+		void parallel_for(size_t count, const std::function<void(size_t)>& body);
+
+	private:
+		struct Task {
+			std::function<void()> function;
+			TaskGroup* group;
+		};
+		struct Queue {
+			std::mutex mutex;
+			std::deque<Task> tasks;
+		};
+
+		std::vector<std::unique_ptr<Queue>> m_queues;
+		std::vector<std::thread>            m_workers;
+		std::atomic<size_t>                 m_queued;
+		std::atomic<bool>                   m_stop;
+		std::mutex                          m_sleepmutex;
+		std::condition_variable             m_wakeup;
+
+		void push(size_t queue, Task task);
+		bool pop(size_t queue, Task& task);
+		bool steal(size_t queue, Task& task);
+		bool next(size_t queue, Task& task);
+		void execute(Task& task);
+		void work(size_t queue);
+		size_t current_queue() const;
+	};
+
+	/**
+	 * returns the thread pool shared by all tracers
+	 * @return global thread pool
+	 */
+	ThreadPool& thread_pool();
+	/**
+	 * recreates the global thread pool with the specified number of threads.
+	 * must not be called while the pool is in use
+	 * @param threads - number of threads, 0 uses all hardware threads
+	 */
+	void set_thread_count(size_t threads);
+}
+
+#endif//THREAD_POOL_H
\ No newline at end of file
@@ -0,0 +1,36 @@
+#include "tiles.h"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+
+#include "io/console.h"
+#include "threadpool.h"
+
+std::vector<rt::Tile> rt::create_tiles(size_t width, size_t height, size_t tilesize) {
+	std::vector<Tile> tiles;
+	for (size_t y = 0; y < height; y += tilesize) {
+		for (size_t x = 0; x < width; x += tilesize) {
+			tiles.push_back({ x, y, std::min(x + tilesize, width), std::min(y + tilesize, height) });
+		}
+	}
+	return tiles;
+}
+
+void rt::render_tiles(size_t width, size_t height, std::string msg, const std::function<void(const Tile&)>& render) {
+	std::vector<Tile> tiles = create_tiles(width, height);
+	if (tiles.empty()) return;
+
+	// progress is reported by the thread that finished a tile
+	std::mutex progressmutex;
+	size_t finished = 0;
+	console::progress(msg, 0.0);
+
+	thread_pool().parallel_for(tiles.size(), [&](size_t i) {
+		render(tiles.at(i));
+
+		std::lock_guard<std::mutex> lock(progressmutex);
+		++finished;
+		console::progress(msg, static_cast<double>(finished) / static_cast<double>(tiles.size()));
+	});
+}
\ No newline at end of file
@@ -0,0 +1,39 @@
+#ifndef TILES_H
+#define TILES_H
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace rt {
+	/**
+	 * rectangular region of the image plane in the pixel
+	 * range [x0, x1) x [y0, y1)
+	 */
+	struct Tile {
+		size_t x0, y0;
+		size_t x1, y1;
+	};
+
+	/**
+	 * splits the image plane into tiles of the specified size. tiles
+	 * at the right and bottom border might be smaller
+	 * @param width - width of the image plane
+	 * @param height - height of the image plane
+	 * @param tilesize - width and height of one tile
+	 * @return list of tiles covering the image plane in scanline order
+	 */
+	std::vector<Tile> create_tiles(size_t width, size_t height, size_t tilesize = 16);
+
+	/**
+	 * renders all tiles of the image plane in parallel on the global thread
+	 * pool and reports the progress on the console
+	 * @param width - width of the image plane
+	 * @param height - height of the image plane
+	 * @param msg - message shown in front of the progress bar
+	 * @param render - function that renders a single tile
+	 */
+	void render_tiles(size_t width, size_t height, std::string msg, const std::function<void(const Tile&)>& render);
+}
+
+#endif//TILES_H
\ No newline at end of file
@@ -1,5 +1,7 @@
 #include "dofcamera.h"
 
+#include "math/sampling.h"
+
 rt::DOFCamera::DOFCamera() { }
 rt::DOFCamera::DOFCamera(vec3 pos, vec3 lookAt, vec3 up, double verticalFov, double aspectRatio, double aperture) {
 	// calculate size of the thin lens
@@ -22,7 +24,9 @@ rt::DOFCamera::DOFCamera(vec3 pos, vec3 lookAt, vec3 up, double verticalFov, dou
 }
 
 rt::ray rt::DOFCamera::get_ray(double s, double t) {
-	vec3 rd = m_lensradius * disk_sampling();
+	double u1 = drand();
+	double u2 = drand();
+	vec3 rd = m_lensradius * concentric_disk(u1, u2);
 	vec3 offset(s * rd.x, t * rd.y, 0);
 	return ray(m_origin + offset, m_upperleftcorner + s * m_horizontal + t * m_vertical - m_origin - offset);
 }
@@ -42,6 +46,7 @@ rt::vec3  rt::DOFCamera::get_image_plane_xaxis()  { return m_horizontal;      }
 rt::vec3  rt::DOFCamera::get_image_plane_yaxis()  { return m_vertical;        }
 float     rt::DOFCamera::get_image_plane_width()  { return 2 * m_halfwidth;   }
 float     rt::DOFCamera::get_image_plane_height() { return 2 * m_halfheight;  }
+double    rt::DOFCamera::get_lens_radius()        { return m_lensradius;      }
 
 void rt::DOFCamera::calculate_coordinate_system() {
 	m_w = normalize(m_pos - m_lookat);
@@ -52,12 +57,4 @@ void rt::DOFCamera::calculate_coordinate_system() {
 	m_upperleftcorner = m_origin - m_halfwidth * m_focusdist * m_u + m_halfheight * m_focusdist * m_v - m_focusdist * m_w;
 	m_horizontal = 2.0 * m_halfwidth * m_focusdist * m_u;
 	m_vertical = -2.0 * m_halfheight * m_focusdist * m_v;
-}
-
-rt::vec3 rt::DOFCamera::disk_sampling() {
-	vec3 p;
-	do {
-		p = 2.0 * vec3(drand(), drand(), 0) - vec3(1, 1, 0);
-	} while (dot(p, p) >= 1.0);
-	return p;
 }
\ No newline at end of file
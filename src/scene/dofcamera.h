@@ -30,6 +30,7 @@ namespace rt {
 		vec3  get_image_plane_yaxis()  override;
 		float get_image_plane_width()  override;
 		float get_image_plane_height() override;
+		double get_lens_radius() override;
 
 	private:
 		// input members
@@ -50,11 +51,6 @@ namespace rt {
 		 * helper function for setting up the camera coordinate system
 		 */
 		void calculate_coordinate_system();
-
-		/**
-		 * returns a random position on a disk
-		 */
-		vec3 disk_sampling();
 	};
 }
 
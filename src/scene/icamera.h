@@ -26,6 +26,9 @@ namespace rt {
 		virtual vec3  get_image_plane_yaxis() = 0;
 		virtual float get_image_plane_width() = 0;
 		virtual float get_image_plane_height() = 0;
+
+		// radius of the lens, 0 for pinhole cameras
+		virtual double get_lens_radius() { return 0.0; }
 	};
 }
 
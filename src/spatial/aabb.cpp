@@ -24,6 +24,12 @@ void rt::aabb::surround(const aabb& box) {
 	m_max = rt::max(m_max, box.max());
 }
 
+double rt::aabb::surface_area() const {
+	vec3 d = m_max - m_min;
+	if (d.x < 0.0 || d.y < 0.0 || d.z < 0.0) return 0.0;
+	return 2.0 * (d.x * d.y + d.y * d.z + d.z * d.x);
+}
+
 rt::aabb rt::surrounding_box(const aabb& box1, const aabb& box2) {
 	vec3 newmin = rt::min(box1.min(), box2.min());
 	vec3 newmax = rt::max(box1.max(), box2.max());
@@ -1,13 +1,15 @@
 #ifndef AABB_H
 #define AABB_H
 
+#include <limits>
+
 #include "scene/ray.h"
 #include "math/vec3.h"
 
 namespace rt {
 class aabb {
 public:
-	aabb() : m_min(DBL_MAX), m_max(-DBL_MAX) {}
+	aabb() : m_min(std::numeric_limits<real>::max()), m_max(-std::numeric_limits<real>::max()) {}
 	aabb(const vec3& vmin, const vec3& vmax) : m_min(vmin), m_max(vmax) {}
 
 	vec3 min() const { return m_min; };
@@ -17,6 +19,12 @@ public:
 	void extend(const vec3& v);
 	void surround(const aabb& box);
 
+	/**
+	 * calculates the surface area of the box
+	 * @return surface area, 0 for an empty box
+	 */
+	double surface_area() const;
+
 	bool hit(const ray& r, double tmin, double tmax) const;
 
 private:
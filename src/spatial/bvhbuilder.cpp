@@ -0,0 +1,285 @@
+#include "bvhbuilder.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "parallel/threadpool.h"
+
+namespace {
+	// number of bins per axis used to evaluate the split candidates
+	const size_t BIN_COUNT = 16;
+	// subtrees with more references are built as separate tasks
+	const size_t TASK_THRESHOLD = 4096;
+	// number of references per chunk when bounds and bins are computed in parallel
+	const size_t CHUNK_SIZE = 16384;
+
+	struct Bin {
+		rt::aabb bounds;
+		size_t count = 0;
+	};
+	struct Bins {
+		Bin axes[3][BIN_COUNT];
+	};
+	struct Bounds {
+		rt::aabb bounds;
+		rt::aabb centroidbounds;
+	};
+
+	size_t bin_index(double centroid, double min, double scale) {
+		size_t index = static_cast<size_t>((centroid - min) * scale);
+		return std::min(index, BIN_COUNT - 1);
+	}
+
+	/**
+	 * processes the range [begin, end) in chunks and merges the results of
+	 * all chunks. the chunks are processed on the thread pool if parallel is set
+	 */
+	template <typename T, typename Process, typename Merge>
+	T reduce_chunks(size_t begin, size_t end, bool parallel, Process process, Merge merge) {
+		size_t chunks = parallel ? (end - begin) / CHUNK_SIZE : 0;
+		if (chunks <= 1) {
+			T result;
+			process(begin, end, result);
+			return result;
+		}
+
+		std::vector<T> results(chunks);
+		rt::thread_pool().parallel_for(chunks, [&](size_t i) {
+			size_t chunkbegin = begin + i * (end - begin) / chunks;
+			size_t chunkend   = begin + (i + 1) * (end - begin) / chunks;
+			process(chunkbegin, chunkend, results[i]);
+		});
+		for (size_t i = 1; i < chunks; ++i) merge(results[0], results[i]);
+		return results[0];
+	}
+
+	Bounds compute_bounds(const std::vector<rt::PrimitiveReference>& references, size_t begin, size_t end, bool parallel) {
+		return reduce_chunks<Bounds>(begin, end, parallel,
+			[&](size_t b, size_t e, Bounds& result) {
+				for (size_t i = b; i < e; ++i) {
+					result.bounds.surround(references[i].bounds);
+					result.centroidbounds.extend(references[i].centroid);
+				}
+			},
+			[](Bounds& result, const Bounds& other) {
+				result.bounds.surround(other.bounds);
+				result.centroidbounds.surround(other.centroidbounds);
+			});
+	}
+
+	/**
+	 * appends the nodes of a subtree and relocates their child indices
+	 */
+	uint32_t append_subtree(std::vector<rt::BuildNode>& nodes, const std::vector<rt::BuildNode>& subtree) {
+		uint32_t offset = static_cast<uint32_t>(nodes.size());
+		for (auto node : subtree) {
+			if (!node.leaf()) {
+				node.children[0] += offset;
+				node.children[1] += offset;
+			}
+			nodes.push_back(node);
+		}
+		return offset;
+	}
+}
+
+rt::BVHBuilder::BVHBuilder(size_t maxleafsize, size_t maxdepth, BuilderType type, double traversalcost, double intersectioncost)
+	: m_maxleafsize(std::max(maxleafsize, size_t{ 1 })), m_maxdepth(maxdepth), m_type(type),
+	  m_traversalcost(traversalcost), m_intersectioncost(intersectioncost) { }
+
+std::vector<rt::BuildNode> rt::BVHBuilder::build(std::vector<PrimitiveReference>& references) const {
+	std::vector<BuildNode> nodes;
+	if (references.empty()) return nodes;
+
+	// a balanced tree has about two nodes per leaf
+	nodes.reserve(2 * references.size() / m_maxleafsize + 1);
+	build_subtree(nodes, references, 0, references.size(), 0);
+	return nodes;
+}
+
+double rt::BVHBuilder::sah_cost(const std::vector<BuildNode>& nodes) const {
+	if (nodes.empty()) return 0.0;
+
+	double rootarea = nodes[0].bounds.surface_area();
+	if (rootarea <= 0.0) return 0.0;
+
+	// cost of every node weighted by the probability of a ray hitting it
+	double cost = 0.0;
+	for (auto& node : nodes) {
+		double probability = node.bounds.surface_area() / rootarea;
+		if (node.leaf()) cost += probability * node.count * m_intersectioncost;
+		else             cost += probability * m_traversalcost;
+	}
+	return cost;
+}
+
+uint32_t rt::BVHBuilder::build_node(std::vector<BuildNode>& nodes, std::vector<PrimitiveReference>& references, size_t begin, size_t end, size_t depth) const {
+	// get surrounding bounding box
+	Bounds bounds = compute_bounds(references, begin, end, false);
+
+	// create node
+	uint32_t index = static_cast<uint32_t>(nodes.size());
+	nodes.push_back(BuildNode());
+	nodes[index].bounds = bounds.bounds;
+	nodes[index].begin = static_cast<uint32_t>(begin);
+	nodes[index].count = 0;
+	nodes[index].axis = 0;
+
+	// create a leaf if splitting doesn't pay off
+	uint8_t axis = 0;
+	size_t mid = split(references, begin, end, depth, bounds.bounds, bounds.centroidbounds, axis);
+	if (mid == begin || mid == end) {
+		nodes[index].count = static_cast<uint32_t>(end - begin);
+		return index;
+	}
+
+	// recursively create the hierarchy, the node array
+	// might get reallocated thus children are set by index
+	uint32_t left  = build_node(nodes, references, begin, mid, depth + 1);
+	uint32_t right = build_node(nodes, references, mid,   end, depth + 1);
+	nodes[index].children[0] = left;
+	nodes[index].children[1] = right;
+	nodes[index].axis = axis;
+	return index;
+}
+
+void rt::BVHBuilder::build_subtree(std::vector<BuildNode>& nodes, std::vector<PrimitiveReference>& references, size_t begin, size_t end, size_t depth) const {
+	// small subtrees aren't worth the overhead of a task
+	if (m_type == SAH_BUILDER || end - begin < TASK_THRESHOLD) {
+		build_node(nodes, references, begin, end, depth);
+		return;
+	}
+
+	// get surrounding bounding box
+	Bounds bounds = compute_bounds(references, begin, end, true);
+
+	// create node
+	nodes.push_back(BuildNode());
+	nodes[0].bounds = bounds.bounds;
+	nodes[0].begin = static_cast<uint32_t>(begin);
+	nodes[0].count = 0;
+	nodes[0].axis = 0;
+
+	// create a leaf if splitting doesn't pay off
+	uint8_t axis = 0;
+	size_t mid = split(references, begin, end, depth, bounds.bounds, bounds.centroidbounds, axis);
+	if (mid == begin || mid == end) {
+		nodes[0].count = static_cast<uint32_t>(end - begin);
+		return;
+	}
+
+	// build the left subtree as a task while this thread builds
+	// the right one, both subtrees work on disjoint references
+	std::vector<BuildNode> left, right;
+	TaskGroup group;
+	thread_pool().run(group, [&]() { build_subtree(left, references, begin, mid, depth + 1); });
+	build_subtree(right, references, mid, end, depth + 1);
+	thread_pool().wait(group);
+
+	nodes[0].children[0] = append_subtree(nodes, left);
+	nodes[0].children[1] = append_subtree(nodes, right);
+	nodes[0].axis = axis;
+}
+
+size_t rt::BVHBuilder::split(std::vector<PrimitiveReference>& references, size_t begin, size_t end, size_t depth, const aabb& bounds, const aabb& centroidbounds, uint8_t& axis) const {
+	size_t count = end - begin;
+	if (count <= 1) return begin;
+
+	// the bins are spread over the bounds of the centroids
+	vec3 cmin = centroidbounds.min();
+	vec3 extent = centroidbounds.max() - cmin;
+	axis = (extent.x > extent.y) ? ((extent.x > extent.z) ? 0 : 2) : ((extent.y > extent.z) ? 1 : 2);
+
+	// split too deep trees and coinciding centroids at the median
+	if (depth >= m_maxdepth || extent[axis] <= 0.0) {
+		if (count <= m_maxleafsize) return begin;
+		return split_median(references, begin, end, axis);
+	}
+
+	// sort the references into the bins of all axes
+	double scale[3];
+	for (size_t a = 0; a < 3; ++a) {
+		scale[a] = (extent[a] > 0.0) ? BIN_COUNT / extent[a] : 0.0;
+	}
+	Bins bins = reduce_chunks<Bins>(begin, end, m_type == PARALLEL_SAH_BUILDER,
+		[&](size_t b, size_t e, Bins& result) {
+			for (size_t i = b; i < e; ++i) {
+				for (size_t a = 0; a < 3; ++a) {
+					Bin& bin = result.axes[a][bin_index(references[i].centroid[a], cmin[a], scale[a])];
+					bin.bounds.surround(references[i].bounds);
+					bin.count++;
+				}
+			}
+		},
+		[](Bins& result, const Bins& other) {
+			for (size_t a = 0; a < 3; ++a) {
+				for (size_t b = 0; b < BIN_COUNT; ++b) {
+					result.axes[a][b].bounds.surround(other.axes[a][b].bounds);
+					result.axes[a][b].count += other.axes[a][b].count;
+				}
+			}
+		});
+
+	// find the bin boundary with the lowest cost over all axes.
+	// costs are not normalized by the area of the node
+	double bestcost = std::numeric_limits<double>::infinity();
+	size_t bestbin = 0;
+	uint8_t bestaxis = axis;
+	for (uint8_t a = 0; a < 3; ++a) {
+		if (extent[a] <= 0.0) continue;
+		const Bin* axisbins = bins.axes[a];
+
+		// sweep from the right to get the partitions right of each boundary
+		double rightarea[BIN_COUNT];
+		size_t rightcount[BIN_COUNT];
+		aabb rightbounds;
+		size_t rightsum = 0;
+		for (size_t b = BIN_COUNT - 1; b > 0; --b) {
+			rightbounds.surround(axisbins[b].bounds);
+			rightsum += axisbins[b].count;
+			rightarea[b] = rightbounds.surface_area();
+			rightcount[b] = rightsum;
+		}
+
+		// sweep from the left and evaluate the boundary between bin b-1 and b
+		aabb leftbounds;
+		size_t leftsum = 0;
+		for (size_t b = 1; b < BIN_COUNT; ++b) {
+			leftbounds.surround(axisbins[b - 1].bounds);
+			leftsum += axisbins[b - 1].count;
+			if (leftsum == 0 || rightcount[b] == 0) continue;
+
+			double cost = leftbounds.surface_area() * leftsum + rightarea[b] * rightcount[b];
+			if (cost < bestcost) {
+				bestcost = cost;
+				bestbin = b;
+				bestaxis = a;
+			}
+		}
+	}
+
+	// compare the best split against a leaf containing all references
+	double area = bounds.surface_area();
+	double leafcost  = m_intersectioncost * count * area;
+	double splitcost = m_traversalcost * area + m_intersectioncost * bestcost;
+	if (count <= m_maxleafsize && leafcost <= splitcost) return begin;
+	if (bestcost == std::numeric_limits<double>::infinity()) return split_median(references, begin, end, axis);
+
+	// partition the references at the chosen bin boundary
+	axis = bestaxis;
+	double min = cmin[axis];
+	double axisscale = scale[axis];
+	auto it = std::partition(references.begin() + begin, references.begin() + end, [&](const PrimitiveReference& reference) {
+		return bin_index(reference.centroid[axis], min, axisscale) < bestbin;
+	});
+	return static_cast<size_t>(it - references.begin());
+}
+
+size_t rt::BVHBuilder::split_median(std::vector<PrimitiveReference>& references, size_t begin, size_t end, uint8_t axis) const {
+	size_t mid = begin + (end - begin) / 2;
+	std::nth_element(references.begin() + begin, references.begin() + mid, references.begin() + end,
+		[axis](const PrimitiveReference& a, const PrimitiveReference& b) {
+		return a.centroid[axis] < b.centroid[axis];
+	});
+	return mid;
+}
\ No newline at end of file
@@ -0,0 +1,87 @@
+#ifndef BVH_BUILDER_H
+#define BVH_BUILDER_H
+
+#include <cstdint>
+#include <vector>
+
+#include "aabb.h"
+#include "math/vec3.h"
+
+namespace rt {
+	/**
+	 * reference to a primitive that is used while building a hierarchy.
+	 * bounds and centroid are computed once up front
+	 */
+	struct PrimitiveReference {
+		aabb bounds;
+		vec3 centroid;
+		uint32_t index;
+	};
+
+	/**
+	 * node of a binary hierarchy created by the builder. interior nodes store
+	 * the indices of their children, leaves store the range [begin, begin+count)
+	 * of the reordered primitive references
+	 */
+	struct BuildNode {
+		aabb bounds;
+		uint32_t children[2];
+		uint32_t begin;
+		uint32_t count;
+		uint8_t axis;
+
+		bool leaf() const { return count > 0; }
+	};
+
+	/**
+	 * algorithm used to build a hierarchy
+	 */
+	enum BuilderType {
+		SAH_BUILDER,
+		PARALLEL_SAH_BUILDER
+	};
+
+	/**
+	 * top down builder that splits the primitives based on a binned
+	 * surface area heuristic. the parallel variant builds big subtrees as
+	 * tasks on the thread pool and bins the references of big nodes in
+	 * parallel, it creates the same hierarchy as the serial variant
+	 */
+	class BVHBuilder {
+	public:
+		/**
+		 * @param maxleafsize - maximal number of primitives in a leaf
+		 * @param maxdepth - depth after which the primitives are split at their median
+		 * @param type - serial or parallel construction
+		 * @param traversalcost - cost of traversing an interior node
+		 * @param intersectioncost - cost of intersecting a single primitive
+		 */
+		BVHBuilder(size_t maxleafsize = 8, size_t maxdepth = 64, BuilderType type = SAH_BUILDER, double traversalcost = 1.0, double intersectioncost = 1.0);
+
+		/**
+		 * builds a hierarchy over the primitive references. the references get
+		 * reordered so that each leaf covers a contiguous range of them
+		 * @param references - references to the primitives
+		 * @return nodes of the hierarchy, the root is the first node
+		 */
+		std::vector<BuildNode> build(std::vector<PrimitiveReference>& references) const;
+		/**
+		 * calculates the expected cost of tracing a ray through the hierarchy
+		 * @param nodes - nodes of the hierarchy
+		 * @return surface area heuristic cost of the hierarchy
+		 */
+		double sah_cost(const std::vector<BuildNode>& nodes) const;
+
+	private:
+		size_t m_maxleafsize, m_maxdepth;
+		BuilderType m_type;
+		double m_traversalcost, m_intersectioncost;
+
+		uint32_t build_node(std::vector<BuildNode>& nodes, std::vector<PrimitiveReference>& references, size_t begin, size_t end, size_t depth) const;
+		void build_subtree(std::vector<BuildNode>& nodes, std::vector<PrimitiveReference>& references, size_t begin, size_t end, size_t depth) const;
+		size_t split(std::vector<PrimitiveReference>& references, size_t begin, size_t end, size_t depth, const aabb& bounds, const aabb& centroidbounds, uint8_t& axis) const;
+		size_t split_median(std::vector<PrimitiveReference>& references, size_t begin, size_t end, uint8_t axis) const;
+	};
+}
+
+#endif//BVH_BUILDER_H
\ No newline at end of file
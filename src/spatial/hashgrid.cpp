@@ -0,0 +1,88 @@
+#include "hashgrid.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cfloat>
+
+namespace {
+	// smallest cell size, avoids dividing by zero for points without extent
+	const double MIN_CELL_SIZE = 1e-6;
+	// every sphere overlaps at most two cells per axis
+	const size_t MAX_BUCKETS = 8;
+}
+
+void rt::HashGrid::build(const std::vector<vec3>& centers, const std::vector<double>& radii) {
+	m_offsets.clear();
+	m_indices.clear();
+
+	// bounds of all spheres and the radius of the biggest one
+	size_t count = 0;
+	double maxradius = 0.0;
+	m_min = vec3(FLT_MAX);
+	m_max = vec3(-FLT_MAX);
+	for (size_t i = 0; i < centers.size(); ++i) {
+		if (radii[i] <= 0.0) continue;
+		m_min = min(m_min, centers[i] - vec3(radii[i]));
+		m_max = max(m_max, centers[i] + vec3(radii[i]));
+		maxradius = std::max(maxradius, radii[i]);
+		++count;
+	}
+	if (count == 0) return;
+
+	m_cellsize = std::max(2.0 * maxradius, MIN_CELL_SIZE);
+	m_inverse = 1.0 / m_cellsize;
+
+	// collects the distinct buckets of the cells that a sphere overlaps,
+	// two of its cells might end up in the same bucket
+	m_offsets.assign(count + 1, 0);
+	auto overlapped = [&](size_t i, size_t buckets[MAX_BUCKETS]) {
+		vec3 lo = (centers[i] - vec3(radii[i]) - m_min) * m_inverse;
+		vec3 hi = (centers[i] + vec3(radii[i]) - m_min) * m_inverse;
+
+		size_t found = 0;
+		for (int64_t z = static_cast<int64_t>(lo.z); z <= static_cast<int64_t>(hi.z); ++z) {
+			for (int64_t y = static_cast<int64_t>(lo.y); y <= static_cast<int64_t>(hi.y); ++y) {
+				for (int64_t x = static_cast<int64_t>(lo.x); x <= static_cast<int64_t>(hi.x); ++x) {
+					size_t b = bucket(x, y, z);
+					if (std::find(buckets, buckets + found, b) == buckets + found && found < MAX_BUCKETS) buckets[found++] = b;
+				}
+			}
+		}
+		return found;
+	};
+
+	// count the spheres per bucket, turn the counts into offsets
+	// and sort the spheres into their buckets
+	size_t buckets[MAX_BUCKETS];
+	for (size_t i = 0; i < centers.size(); ++i) {
+		if (radii[i] <= 0.0) continue;
+		size_t found = overlapped(i, buckets);
+		for (size_t j = 0; j < found; ++j) ++m_offsets[buckets[j] + 1];
+	}
+	for (size_t b = 0; b < count; ++b) m_offsets[b + 1] += m_offsets[b];
+
+	m_indices.resize(m_offsets[count]);
+	std::vector<uint32_t> fill(m_offsets.begin(), m_offsets.end() - 1);
+	for (size_t i = 0; i < centers.size(); ++i) {
+		if (radii[i] <= 0.0) continue;
+		size_t found = overlapped(i, buckets);
+		for (size_t j = 0; j < found; ++j) m_indices[fill[buckets[j]]++] = static_cast<uint32_t>(i);
+	}
+}
+
+std::pair<const uint32_t*, const uint32_t*> rt::HashGrid::candidates(const vec3& p) const {
+	if (m_offsets.empty()) return { nullptr, nullptr };
+	for (int i = 0; i < 3; ++i) {
+		if (p[i] < m_min[i] || p[i] > m_max[i]) return { nullptr, nullptr };
+	}
+
+	vec3 cell = (p - m_min) * m_inverse;
+	size_t b = bucket(static_cast<int64_t>(cell.x), static_cast<int64_t>(cell.y), static_cast<int64_t>(cell.z));
+	return { m_indices.data() + m_offsets[b], m_indices.data() + m_offsets[b + 1] };
+}
+
+size_t rt::HashGrid::bucket(int64_t x, int64_t y, int64_t z) const {
+	// spatial hash by Teschner et al.
+	uint64_t h = (static_cast<uint64_t>(x) * 73856093u) ^ (static_cast<uint64_t>(y) * 19349663u) ^ (static_cast<uint64_t>(z) * 83492791u);
+	return static_cast<size_t>(h % (m_offsets.size() - 1));
+}
\ No newline at end of file
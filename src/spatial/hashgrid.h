@@ -0,0 +1,47 @@
+#ifndef HASH_GRID_H
+#define HASH_GRID_H
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "math/vec3.h"
+
+namespace rt {
+	/**
+	 * uniform grid over a set of spheres whose cells are hashed into a table
+	 * with one bucket per sphere. the cells are as wide as the biggest sphere,
+	 * thus every sphere overlaps at most 8 cells and the memory of the grid
+	 * only depends on the number of spheres, not on the extent of the scene.
+	 * cells that share a bucket share their candidates, thus queries have to
+	 * test the distance to the returned spheres
+	 */
+	class HashGrid {
+	public:
+		HashGrid() : m_cellsize(1.0), m_inverse(1.0) {}
+
+		/**
+		 * builds the grid, which replaces the spheres it contained before
+		 * @param centers - centers of the spheres
+		 * @param radii - radii of the spheres, spheres with a radius of 0 are skipped
+		 */
+		void build(const std::vector<vec3>& centers, const std::vector<double>& radii);
+
+		/**
+		 * returns the spheres that might contain a point
+		 * @param p - point to look up
+		 * @return range of the indices of the spheres, empty if p is outside the grid
+		 */
+		std::pair<const uint32_t*, const uint32_t*> candidates(const vec3& p) const;
+
+	private:
+		vec3                  m_min, m_max;
+		double                m_cellsize, m_inverse;
+		std::vector<uint32_t> m_offsets;
+		std::vector<uint32_t> m_indices;
+
+		size_t bucket(int64_t x, int64_t y, int64_t z) const;
+	};
+}
+
+#endif//HASH_GRID_H
\ No newline at end of file
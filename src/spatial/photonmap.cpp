@@ -0,0 +1,102 @@
+#include "photonmap.h"
+
+#include <algorithm>
+
+namespace {
+	/**
+	 * number of nodes in the left subtree of a left balanced tree, all
+	 * levels are full except the last one which is filled from the left
+	 * @param count - number of nodes of the tree
+	 * @return number of nodes left of the root
+	 */
+	size_t left_subtree_size(size_t count) {
+		if (count <= 1) return 0;
+
+		// height of the full part of the tree
+		size_t height = 0;
+		while ((size_t(2) << height) - 1 <= count) ++height;
+
+		// nodes of the last level that end up in the left subtree
+		size_t full = (size_t(1) << height) - 1;
+		size_t last = count - full;
+		size_t half = size_t(1) << (height - 1);
+		return (half - 1) + std::min(last, half);
+	}
+}
+
+rt::Photon::Photon(const vec3& p, const vec3& pow, const vec3& dir) : axis(0) {
+	for (int i = 0; i < 3; ++i) {
+		position[i] = static_cast<float>(p[i]);
+		power[i] = static_cast<float>(pow[i]);
+		direction[i] = static_cast<float>(dir[i]);
+	}
+}
+
+void rt::PhotonMap::build(std::vector<Photon> photons) {
+	m_photons.assign(photons.size(), Photon());
+	if (!photons.empty()) balance(photons, 0, photons.size(), 0);
+}
+
+void rt::PhotonMap::balance(std::vector<Photon>& photons, size_t begin, size_t end, size_t node) {
+	// split along the axis with the largest extent
+	float bmin[3] = { photons[begin].position[0], photons[begin].position[1], photons[begin].position[2] };
+	float bmax[3] = { bmin[0], bmin[1], bmin[2] };
+	for (size_t i = begin + 1; i < end; ++i) {
+		for (int a = 0; a < 3; ++a) {
+			bmin[a] = std::min(bmin[a], photons[i].position[a]);
+			bmax[a] = std::max(bmax[a], photons[i].position[a]);
+		}
+	}
+	uint32_t axis = 0;
+	if (bmax[1] - bmin[1] > bmax[axis] - bmin[axis]) axis = 1;
+	if (bmax[2] - bmin[2] > bmax[axis] - bmin[axis]) axis = 2;
+
+	// the median is chosen such that the tree stays left balanced
+	size_t median = begin + left_subtree_size(end - begin);
+	std::nth_element(photons.begin() + begin, photons.begin() + median, photons.begin() + end, [axis](const Photon& a, const Photon& b) {
+		return a.position[axis] < b.position[axis];
+	});
+
+	m_photons[node] = photons[median];
+	m_photons[node].axis = axis;
+	if (begin < median) balance(photons, begin, median, 2 * node + 1);
+	if (median + 1 < end) balance(photons, median + 1, end, 2 * node + 2);
+}
+
+void rt::PhotonMap::nearest(const vec3& p, size_t k, float maxdistance2, std::vector<PhotonNeighbor>& neighbors) const {
+	neighbors.clear();
+	if (m_photons.empty() || k == 0) return;
+
+	float position[3] = { static_cast<float>(p[0]), static_cast<float>(p[1]), static_cast<float>(p[2]) };
+	locate(position, 0, k, maxdistance2, neighbors);
+}
+
+void rt::PhotonMap::locate(const float p[3], size_t node, size_t k, float& maxdistance2, std::vector<PhotonNeighbor>& neighbors) const {
+	const Photon& photon = m_photons[node];
+
+	// visit the side of the splitting plane that contains the point first
+	size_t left = 2 * node + 1;
+	if (left < m_photons.size()) {
+		float delta = p[photon.axis] - photon.position[photon.axis];
+		size_t first = (delta < 0.f) ? left : left + 1;
+		size_t second = (delta < 0.f) ? left + 1 : left;
+		if (first < m_photons.size()) locate(p, first, k, maxdistance2, neighbors);
+		if (delta * delta < maxdistance2 && second < m_photons.size()) locate(p, second, k, maxdistance2, neighbors);
+	}
+
+	float dx = photon.position[0] - p[0];
+	float dy = photon.position[1] - p[1];
+	float dz = photon.position[2] - p[2];
+	float distance2 = dx * dx + dy * dy + dz * dz;
+	if (distance2 >= maxdistance2) return;
+
+	// keep the k closest photons, once k are found the search
+	// radius shrinks to the farthest of them
+	if (neighbors.size() == k) {
+		std::pop_heap(neighbors.begin(), neighbors.end());
+		neighbors.pop_back();
+	}
+	neighbors.push_back({ distance2, static_cast<uint32_t>(node) });
+	std::push_heap(neighbors.begin(), neighbors.end());
+	if (neighbors.size() == k) maxdistance2 = neighbors.front().distance2;
+}
\ No newline at end of file
@@ -0,0 +1,82 @@
+#ifndef PHOTON_MAP_H
+#define PHOTON_MAP_H
+
+#include <cstdint>
+#include <vector>
+
+#include "math/vec3.h"
+
+namespace rt {
+	/**
+	 * photon that has been stored at a surface. single precision
+	 * keeps the photons small, the split axis is set by the map
+	 */
+	struct Photon {
+		float    position[3];
+		float    power[3];
+		float    direction[3];
+		uint32_t axis;
+
+		Photon() = default;
+		Photon(const vec3& p, const vec3& pow, const vec3& dir);
+	};
+
+	/**
+	 * neighbor found by a nearest neighbor query
+	 */
+	struct PhotonNeighbor {
+		float    distance2;
+		uint32_t index;
+
+		bool operator<(const PhotonNeighbor& n) const { return distance2 < n.distance2; }
+	};
+
+	/**
+	 * photons stored in a left balanced kd-tree. the tree is laid out like
+	 * a heap, the children of node i are 2i+1 and 2i+2, thus no child
+	 * pointers are needed and the upper levels share few cache lines
+	 */
+	class PhotonMap {
+	public:
+		/**
+		 * builds the tree from a list of photons, which replaces the
+		 * photons the map contained before
+		 * @param photons - photons to store
+		 */
+		void build(std::vector<Photon> photons);
+
+		/**
+		 * returns the number of photons
+		 * @return number of photons
+		 */
+		size_t size() const { return m_photons.size(); }
+		/**
+		 * checks if the map contains no photons
+		 * @return true if the map is empty
+		 */
+		bool empty() const { return m_photons.empty(); }
+		/**
+		 * returns the photon at the specified node of the tree
+		 * @param index - index of the node
+		 * @return photon of the node
+		 */
+		const Photon& operator[](size_t index) const { return m_photons[index]; }
+
+		/**
+		 * finds the k nearest photons to a point within a maximum distance
+		 * @param p - point to search around
+		 * @param k - maximum number of photons
+		 * @param maxdistance2 - squared maximum distance
+		 * @param neighbors - found photons as max heap, the farthest is the first element
+		 */
+		void nearest(const vec3& p, size_t k, float maxdistance2, std::vector<PhotonNeighbor>& neighbors) const;
+
+	private:
+		std::vector<Photon> m_photons;
+
+		void balance(std::vector<Photon>& photons, size_t begin, size_t end, size_t node);
+		void locate(const float p[3], size_t node, size_t k, float& maxdistance2, std::vector<PhotonNeighbor>& neighbors) const;
+	};
+}
+
+#endif//PHOTON_MAP_H
\ No newline at end of file
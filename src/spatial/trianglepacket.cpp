@@ -0,0 +1,186 @@
+#include "trianglepacket.h"
+
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RT_SSE
+#include <immintrin.h>
+#endif
+#if defined(__AVX__)
+#define RT_AVX
+#endif
+
+#include "math/constants.h"
+
+namespace {
+	const float EPS = static_cast<float>(rt::EPS);
+}
+
+rt::PacketRay::PacketRay(const ray& r) {
+	for (size_t i = 0; i < 3; ++i) {
+		o[i] = static_cast<float>(r.o[i]);
+		dir[i] = static_cast<float>(r.dir[i]);
+	}
+}
+
+rt::TrianglePacket::TrianglePacket() {
+	for (size_t a = 0; a < 3; ++a) {
+		for (size_t i = 0; i < TRIANGLE_PACKET_WIDTH; ++i) {
+			p1[a][i] = 0.f;
+			e1[a][i] = 0.f;
+			e2[a][i] = 0.f;
+		}
+	}
+	for (size_t i = 0; i < TRIANGLE_PACKET_WIDTH; ++i) {
+		indices[i] = std::numeric_limits<uint32_t>::max();
+	}
+}
+
+void rt::TrianglePacket::set(size_t lane, const vec3& a, const vec3& b, const vec3& c, uint32_t index) {
+	// edges are computed in double precision before rounding
+	vec3 v1 = b - a;
+	vec3 v2 = c - a;
+	for (size_t i = 0; i < 3; ++i) {
+		p1[i][lane] = static_cast<float>(a[i]);
+		e1[i][lane] = static_cast<float>(v1[i]);
+		e2[i][lane] = static_cast<float>(v2[i]);
+	}
+	indices[lane] = index;
+}
+
+bool rt::TrianglePacket::intersect(const PacketRay& r, float tmin, float& tmax, uint32_t& index, float& u, float& v) const {
+	const size_t W = TRIANGLE_PACKET_WIDTH;
+	alignas(32) float tt[W], uu[W], vv[W];
+	uint32_t mask = hit_lanes(r, tmin, tmax, tt, uu, vv);
+	if (mask == 0) return false;
+
+	// pick the closest of the lanes that were hit
+	size_t closest = W;
+	for (size_t i = 0; i < W; ++i) {
+		if ((mask & (1u << i)) && (closest == W || tt[i] < tt[closest])) closest = i;
+	}
+
+	tmax = tt[closest];
+	index = indices[closest];
+	u = uu[closest];
+	v = vv[closest];
+	return true;
+}
+
+bool rt::TrianglePacket::occluded(const PacketRay& r, float tmin, float tmax) const {
+	alignas(32) float tt[TRIANGLE_PACKET_WIDTH], uu[TRIANGLE_PACKET_WIDTH], vv[TRIANGLE_PACKET_WIDTH];
+	return hit_lanes(r, tmin, tmax, tt, uu, vv) != 0;
+}
+
+uint32_t rt::TrianglePacket::hit_lanes(const PacketRay& r, float tmin, float tmax, float* tt, float* uu, float* vv) const {
+	const size_t W = TRIANGLE_PACKET_WIDTH;
+	uint32_t mask = 0;
+
+	// moeller-trumbore algorithm for all lanes. lanes that miss get
+	// masked out, the closest remaining lane is picked afterwards
+#if defined(RT_AVX)
+	{
+		__m256 dx = _mm256_set1_ps(r.dir[0]), dy = _mm256_set1_ps(r.dir[1]), dz = _mm256_set1_ps(r.dir[2]);
+		__m256 e1x = _mm256_load_ps(e1[0]), e1y = _mm256_load_ps(e1[1]), e1z = _mm256_load_ps(e1[2]);
+		__m256 e2x = _mm256_load_ps(e2[0]), e2y = _mm256_load_ps(e2[1]), e2z = _mm256_load_ps(e2[2]);
+
+		// pvec = dir x e2, det = e1 . pvec
+		__m256 px = _mm256_sub_ps(_mm256_mul_ps(dy, e2z), _mm256_mul_ps(dz, e2y));
+		__m256 py = _mm256_sub_ps(_mm256_mul_ps(dz, e2x), _mm256_mul_ps(dx, e2z));
+		__m256 pz = _mm256_sub_ps(_mm256_mul_ps(dx, e2y), _mm256_mul_ps(dy, e2x));
+		__m256 det = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(e1x, px), _mm256_mul_ps(e1y, py)), _mm256_mul_ps(e1z, pz));
+		__m256 absdet = _mm256_andnot_ps(_mm256_set1_ps(-0.f), det);
+		__m256 valid = _mm256_cmp_ps(absdet, _mm256_set1_ps(EPS), _CMP_GE_OQ);
+		__m256 invdet = _mm256_div_ps(_mm256_set1_ps(1.f), det);
+
+		// tvec = o - p1, u = tvec . pvec
+		__m256 tx = _mm256_sub_ps(_mm256_set1_ps(r.o[0]), _mm256_load_ps(p1[0]));
+		__m256 ty = _mm256_sub_ps(_mm256_set1_ps(r.o[1]), _mm256_load_ps(p1[1]));
+		__m256 tz = _mm256_sub_ps(_mm256_set1_ps(r.o[2]), _mm256_load_ps(p1[2]));
+		__m256 bu = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(tx, px), _mm256_mul_ps(ty, py)), _mm256_mul_ps(tz, pz)), invdet);
+
+		// qvec = tvec x e1, v = dir . qvec, t = e2 . qvec
+		__m256 qx = _mm256_sub_ps(_mm256_mul_ps(ty, e1z), _mm256_mul_ps(tz, e1y));
+		__m256 qy = _mm256_sub_ps(_mm256_mul_ps(tz, e1x), _mm256_mul_ps(tx, e1z));
+		__m256 qz = _mm256_sub_ps(_mm256_mul_ps(tx, e1y), _mm256_mul_ps(ty, e1x));
+		__m256 bv = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, qx), _mm256_mul_ps(dy, qy)), _mm256_mul_ps(dz, qz)), invdet);
+		__m256 t  = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(e2x, qx), _mm256_mul_ps(e2y, qy)), _mm256_mul_ps(e2z, qz)), invdet);
+
+		__m256 zero = _mm256_setzero_ps();
+		valid = _mm256_and_ps(valid, _mm256_cmp_ps(bu, zero, _CMP_GE_OQ));
+		valid = _mm256_and_ps(valid, _mm256_cmp_ps(bv, zero, _CMP_GE_OQ));
+		valid = _mm256_and_ps(valid, _mm256_cmp_ps(_mm256_add_ps(bu, bv), _mm256_set1_ps(1.f), _CMP_LE_OQ));
+		valid = _mm256_and_ps(valid, _mm256_cmp_ps(t, _mm256_set1_ps(tmin), _CMP_GE_OQ));
+		valid = _mm256_and_ps(valid, _mm256_cmp_ps(t, _mm256_set1_ps(tmax), _CMP_LE_OQ));
+		mask = static_cast<uint32_t>(_mm256_movemask_ps(valid));
+
+		_mm256_store_ps(tt, t);
+		_mm256_store_ps(uu, bu);
+		_mm256_store_ps(vv, bv);
+	}
+#elif defined(RT_SSE)
+	for (size_t g = 0; g < W; g += 4) {
+		__m128 dx = _mm_set1_ps(r.dir[0]), dy = _mm_set1_ps(r.dir[1]), dz = _mm_set1_ps(r.dir[2]);
+		__m128 e1x = _mm_load_ps(e1[0] + g), e1y = _mm_load_ps(e1[1] + g), e1z = _mm_load_ps(e1[2] + g);
+		__m128 e2x = _mm_load_ps(e2[0] + g), e2y = _mm_load_ps(e2[1] + g), e2z = _mm_load_ps(e2[2] + g);
+
+		// pvec = dir x e2, det = e1 . pvec
+		__m128 px = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y));
+		__m128 py = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z));
+		__m128 pz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x));
+		__m128 det = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, px), _mm_mul_ps(e1y, py)), _mm_mul_ps(e1z, pz));
+		__m128 absdet = _mm_andnot_ps(_mm_set1_ps(-0.f), det);
+		__m128 valid = _mm_cmpge_ps(absdet, _mm_set1_ps(EPS));
+		__m128 invdet = _mm_div_ps(_mm_set1_ps(1.f), det);
+
+		// tvec = o - p1, u = tvec . pvec
+		__m128 tx = _mm_sub_ps(_mm_set1_ps(r.o[0]), _mm_load_ps(p1[0] + g));
+		__m128 ty = _mm_sub_ps(_mm_set1_ps(r.o[1]), _mm_load_ps(p1[1] + g));
+		__m128 tz = _mm_sub_ps(_mm_set1_ps(r.o[2]), _mm_load_ps(p1[2] + g));
+		__m128 bu = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(tx, px), _mm_mul_ps(ty, py)), _mm_mul_ps(tz, pz)), invdet);
+
+		// qvec = tvec x e1, v = dir . qvec, t = e2 . qvec
+		__m128 qx = _mm_sub_ps(_mm_mul_ps(ty, e1z), _mm_mul_ps(tz, e1y));
+		__m128 qy = _mm_sub_ps(_mm_mul_ps(tz, e1x), _mm_mul_ps(tx, e1z));
+		__m128 qz = _mm_sub_ps(_mm_mul_ps(tx, e1y), _mm_mul_ps(ty, e1x));
+		__m128 bv = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, qx), _mm_mul_ps(dy, qy)), _mm_mul_ps(dz, qz)), invdet);
+		__m128 t  = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)), _mm_mul_ps(e2z, qz)), invdet);
+
+		__m128 zero = _mm_setzero_ps();
+		valid = _mm_and_ps(valid, _mm_cmpge_ps(bu, zero));
+		valid = _mm_and_ps(valid, _mm_cmpge_ps(bv, zero));
+		valid = _mm_and_ps(valid, _mm_cmple_ps(_mm_add_ps(bu, bv), _mm_set1_ps(1.f)));
+		valid = _mm_and_ps(valid, _mm_cmpge_ps(t, _mm_set1_ps(tmin)));
+		valid = _mm_and_ps(valid, _mm_cmple_ps(t, _mm_set1_ps(tmax)));
+		mask |= static_cast<uint32_t>(_mm_movemask_ps(valid)) << g;
+
+		_mm_store_ps(tt + g, t);
+		_mm_store_ps(uu + g, bu);
+		_mm_store_ps(vv + g, bv);
+	}
+#else
+	for (size_t i = 0; i < W; ++i) {
+		float px = r.dir[1] * e2[2][i] - r.dir[2] * e2[1][i];
+		float py = r.dir[2] * e2[0][i] - r.dir[0] * e2[2][i];
+		float pz = r.dir[0] * e2[1][i] - r.dir[1] * e2[0][i];
+		float det = e1[0][i] * px + e1[1][i] * py + e1[2][i] * pz;
+		if (!(det >= EPS || det <= -EPS)) continue;
+		float invdet = 1.f / det;
+
+		float tx = r.o[0] - p1[0][i];
+		float ty = r.o[1] - p1[1][i];
+		float tz = r.o[2] - p1[2][i];
+		uu[i] = (tx * px + ty * py + tz * pz) * invdet;
+
+		float qx = ty * e1[2][i] - tz * e1[1][i];
+		float qy = tz * e1[0][i] - tx * e1[2][i];
+		float qz = tx * e1[1][i] - ty * e1[0][i];
+		vv[i] = (r.dir[0] * qx + r.dir[1] * qy + r.dir[2] * qz) * invdet;
+		tt[i] = (e2[0][i] * qx + e2[1][i] * qy + e2[2][i] * qz) * invdet;
+
+		if (uu[i] >= 0.f && vv[i] >= 0.f && uu[i] + vv[i] <= 1.f && tt[i] >= tmin && tt[i] <= tmax) mask |= 1u << i;
+	}
+#endif
+
+	return mask;
+}
\ No newline at end of file
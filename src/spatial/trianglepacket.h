@@ -0,0 +1,82 @@
+#ifndef TRIANGLE_PACKET_H
+#define TRIANGLE_PACKET_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "scene/ray.h"
+#include "math/vec3.h"
+
+namespace rt {
+	// number of triangles that are intersected at once, 8 with avx and 4 otherwise
+#if defined(__AVX__)
+	const size_t TRIANGLE_PACKET_WIDTH = 8;
+#else
+	const size_t TRIANGLE_PACKET_WIDTH = 4;
+#endif
+
+	/**
+	 * ray in single precision as it is used by the packet test
+	 */
+	struct PacketRay {
+		PacketRay(const ray& r);
+
+		float o[3];
+		float dir[3];
+	};
+
+	/**
+	 * triangles stored as structure of arrays. each lane holds the first
+	 * vertex and the two edges starting at it, which is all the moeller-
+	 * trumbore test needs. unused lanes are degenerate and never hit
+	 */
+	struct alignas(32) TrianglePacket {
+		float p1[3][TRIANGLE_PACKET_WIDTH];
+		float e1[3][TRIANGLE_PACKET_WIDTH];
+		float e2[3][TRIANGLE_PACKET_WIDTH];
+		uint32_t indices[TRIANGLE_PACKET_WIDTH];
+
+		/**
+		 * creates a packet with only degenerate lanes
+		 */
+		TrianglePacket();
+
+		/**
+		 * stores a triangle in one lane of the packet
+		 * @param lane - lane in [0, TRIANGLE_PACKET_WIDTH)
+		 * @param a - first vertex
+		 * @param b - second vertex
+		 * @param c - third vertex
+		 * @param index - index of the triangle that is reported on a hit
+		 */
+		void set(size_t lane, const vec3& a, const vec3& b, const vec3& c, uint32_t index);
+		/**
+		 * intersects the ray with all triangles of the packet at once
+		 * @param r - ray in single precision
+		 * @param tmin - start of the ray interval
+		 * @param tmax - end of the ray interval, set to the closest hit
+		 * @param index - index of the closest triangle that was hit
+		 * @param u - barycentric weight of the second vertex
+		 * @param v - barycentric weight of the third vertex
+		 * @return true if any triangle was hit within [tmin, tmax]
+		 */
+		bool intersect(const PacketRay& r, float tmin, float& tmax, uint32_t& index, float& u, float& v) const;
+		/**
+		 * checks if any triangle of the packet is hit
+		 * @param r - ray in single precision
+		 * @param tmin - start of the ray interval
+		 * @param tmax - end of the ray interval
+		 * @return true if any triangle was hit within [tmin, tmax]
+		 */
+		bool occluded(const PacketRay& r, float tmin, float tmax) const;
+
+	private:
+		/**
+		 * tests all lanes and stores their distances and barycentrics
+		 * @return bit mask of the lanes that were hit within [tmin, tmax]
+		 */
+		uint32_t hit_lanes(const PacketRay& r, float tmin, float tmax, float* tt, float* uu, float* vv) const;
+	};
+}
+
+#endif//TRIANGLE_PACKET_H
\ No newline at end of file
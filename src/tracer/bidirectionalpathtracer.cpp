@@ -0,0 +1,466 @@
+#include "bidirectionalpathtracer.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace {
+	// offset of shadow rays from both of their end points
+	const double SHADOW_EPSILON = 0.001;
+	// random streams of the light subpath and of the connections, the
+	// camera subpath uses the streams of the bounces starting at 1
+	const uint32_t LIGHT_STREAM = 0x10000;
+	const uint32_t CONNECT_STREAM = 0x20000;
+
+	/**
+	 * zero densities belong to specular vertices, which cancel
+	 * out in the ratios of the mis weights
+	 * @param pdf - density
+	 * @return density or 1 if it is 0
+	 */
+	double remap_zero(double pdf) {
+		return (pdf != 0.0) ? pdf : 1.0;
+	}
+}
+
+rt::BidirectionalPathTracer::BidirectionalPathTracer(size_t width, size_t height, size_t samples, size_t maxdepth)
+	: m_width(width), m_height(height), m_samples(samples), m_maxdepth(maxdepth), m_threads(0), m_backgroundcolor(0, 0, 0) {
+	m_framebuffer = HDRImage(width, height);
+}
+
+rt::BidirectionalPathTracer::BidirectionalPathTracer(Resolution r, Samples s, TraceDepth t) : m_threads(0), m_backgroundcolor(0, 0, 0) {
+	// determine resolution
+	auto [width, height] = determine_resolution(r);
+	m_width = width; m_height = height;
+	m_framebuffer = HDRImage(m_width, m_height);
+
+	// determine number of samples
+	m_samples = determine_samples(s);
+
+	// determine ray tracing depth
+	m_maxdepth = determine_trace_depth(t);
+}
+
+void rt::BidirectionalPathTracer::run() {
+	// print tracer settings
+	console::println("TYPE  : BDPT");
+	console::println("RES   : " + std::to_string(m_width) + "x" + std::to_string(m_height));
+	console::println("MSAA  : " + std::to_string(m_samples));
+	console::println("DEPTH : " + std::to_string(m_maxdepth));
+	console::println("LIGHTS: " + std::to_string((m_lights != nullptr) ? m_lights->size() : 0));
+
+	// setup worker threads
+	set_thread_count(m_threads);
+	console::println("THREADS: " + std::to_string(thread_pool().size()));
+
+	// start timer
+	auto starttime = std::chrono::high_resolution_clock::now();
+
+	// light paths can only be connected to the camera if all of its rays
+	// start at the same point. the area of the image plane is taken at
+	// distance 1 to the pinhole
+	m_pinhole.origin = m_camera->get_position();
+	m_pinhole.upperleft = m_camera->get_image_plane_origin();
+	m_pinhole.horizontal = m_camera->get_image_plane_xaxis();
+	m_pinhole.vertical = m_camera->get_image_plane_yaxis();
+	m_pinhole.forward = normalize(cross(m_pinhole.horizontal, m_pinhole.vertical));
+	m_pinhole.distance = dot(m_pinhole.upperleft - m_pinhole.origin, m_pinhole.forward);
+	m_pinhole.enabled = m_camera->get_lens_radius() <= 0.0 && m_pinhole.distance > 0.0;
+	m_pinhole.area = m_pinhole.enabled ? m_pinhole.horizontal.length() * m_pinhole.vertical.length() / (m_pinhole.distance * m_pinhole.distance) : 0.0;
+	if (!m_pinhole.enabled) console::println("BDPT  : light paths aren't connected to cameras with a lens");
+
+	// light tracing contributions of all threads are summed up atomically
+	m_splats = std::vector<std::atomic<double>>(3 * m_width * m_height);
+	for (auto& splat : m_splats) splat.store(0.0);
+	std::vector<vec3> estimates(m_width * m_height, vec3(0, 0, 0));
+	bool samplelights = m_lights != nullptr && !m_lights->empty();
+
+	render_tiles(m_width, m_height, "bdpt", [&](const Tile& tile) {
+		// a path of depth d has at most d+2 camera and d+1 light vertices
+		thread_local std::vector<PathVertex> camerapath, lightpath;
+		camerapath.resize(m_maxdepth + 2);
+		lightpath.resize(m_maxdepth + 1);
+
+		for (size_t y = tile.y0; y < tile.y1; ++y) {
+			for (size_t x = tile.x0; x < tile.x1; ++x) {
+				vec3 col(0, 0, 0);
+				for (size_t sample = 0; sample < m_samples; ++sample) {
+					sampler().start_sample(x + y * m_width, sample);
+					double u = static_cast<double>(x + drand()) / static_cast<double>(m_width);
+					double v = static_cast<double>(y + drand()) / static_cast<double>(m_height);
+					ray r = m_camera->get_ray(u, v);
+					vec3 dir = normalize(r.dir);
+
+					// the camera starts the camera subpath
+					PathVertex& camera = camerapath[0];
+					camera.type = PathVertex::CAMERA;
+					camera.beta = vec3(1, 1, 1);
+					camera.p = r.o;
+					camera.normal = m_pinhole.forward;
+					camera.light = nullptr;
+					camera.delta = !m_pinhole.enabled;
+					camera.pdffwd = camera.pdfrev = 0.0;
+
+					double pdfdir = 1.0;
+					size_t pixel;
+					if (m_pinhole.enabled) camera_importance(dir, pdfdir, pixel);
+
+					vec3 escaped(0, 0, 0);
+					size_t cameravertices = random_walk(ray(r.o, dir), vec3(1, 1, 1), pdfdir, false, camerapath, 1, escaped);
+					size_t lightvertices = samplelights ? light_subpath(lightpath) : 0;
+					col += escaped;
+
+					// connect all prefixes of the subpaths, t = 1 splats
+					// the light subpath onto the pixel it is seen through
+					for (size_t t = 1; t <= cameravertices; ++t) {
+						for (size_t s = 0; s <= lightvertices; ++s) {
+							if ((s == 1 && t == 1) || s + t < 2 || s + t - 2 > m_maxdepth) continue;
+
+							size_t splat = 0;
+							vec3 contribution = connect(lightpath, camerapath, s, t, splat);
+							if (t != 1) {
+								col += contribution;
+							}
+							else if (max_comp(contribution) > 0.0) {
+								for (int i = 0; i < 3; ++i) atomic_add(m_splats[3 * splat + i], contribution[i]);
+							}
+						}
+					}
+				}
+				estimates[x + y * m_width] = col;
+			}
+		}
+	});
+
+	// every camera sample traced one light subpath, thus the splats
+	// are normalized with the number of samples as well
+	for (size_t y = 0; y < m_height; ++y) {
+		for (size_t x = 0; x < m_width; ++x) {
+			size_t i = x + y * m_width;
+			vec3 splat(m_splats[3 * i].load(), m_splats[3 * i + 1].load(), m_splats[3 * i + 2].load());
+			m_framebuffer.set(x, y, (estimates[i] + splat) / static_cast<double>(m_samples));
+		}
+	}
+
+	// print elapsed time
+	auto endtime = std::chrono::high_resolution_clock::now();
+	auto elapsedtime = std::chrono::duration_cast<std::chrono::duration<double>>(endtime - starttime);
+	console::println("elapsed time: " + format_time(elapsedtime.count()));
+}
+
+void rt::BidirectionalPathTracer::write(std::string filepath) const {
+	write_image(filepath, m_framebuffer);
+}
+
+size_t rt::BidirectionalPathTracer::random_walk(ray r, vec3 beta, double pdf, bool lightpath, std::vector<PathVertex>& path, size_t count, vec3& escaped) const {
+	uint32_t stream = lightpath ? LIGHT_STREAM : 0;
+
+	for (uint32_t depth = 1; count < path.size(); ++depth) {
+		// each bounce draws from its own random sequence
+		sampler().start_bounce(stream + depth);
+
+		HitRecord rec;
+		if (!m_world->hit(r, 0.001, FLT_MAX, rec)) {
+			if (!lightpath) escaped += beta * m_backgroundcolor;
+			break;
+		}
+
+		PathVertex& prev = path[count - 1];
+		PathVertex& v = path[count++];
+		v.type = PathVertex::SURFACE;
+		v.beta = beta;
+		v.p = rec.p;
+		v.normal = rec.normal;
+		v.wprev = normalize(-r.dir);
+		v.rec = rec;
+		v.light = nullptr;
+		v.pickpdf = 0.0;
+		v.delta = false;
+		v.pdffwd = convert_density(pdf, prev, v);
+		v.pdfrev = 0.0;
+		if (rec.material->is_emissive() && m_lights != nullptr) v.light = m_lights->find(rec, v.pickpdf);
+		if (count >= path.size()) break;
+
+		// light arriving at the back of a surface can't be reflected by it,
+		// scatter() would send it through the surface. lights end the path
+		// as they don't scatter
+		if (lightpath && !rec.material->is_specular() && dot(rec.normal, v.wprev) <= 0.0) break;
+		ray scattered;
+		vec3 attenuation;
+		if (!rec.material->scatter(r, rec, attenuation, scattered)) break;
+		vec3 wi = normalize(scattered.dir);
+
+		// specular scattering can't be sampled by any other strategy
+		double pdfrev;
+		if (rec.material->is_specular()) {
+			v.delta = true;
+			pdf = pdfrev = 0.0;
+		}
+		else {
+			pdf = rec.material->pdf(rec, v.wprev, wi);
+			pdfrev = rec.material->pdf(rec, wi, v.wprev);
+		}
+
+		beta *= attenuation;
+		if (max_comp(beta) <= 0.0) break;
+		prev.pdfrev = convert_density(pdfrev, v, prev);
+
+		r = ray(rec.p, wi);
+	}
+
+	return count;
+}
+
+size_t rt::BidirectionalPathTracer::light_subpath(std::vector<PathVertex>& path) const {
+	sampler().start_bounce(LIGHT_STREAM);
+
+	// pick a light, a point on it and a direction
+	double pickpdf;
+	const ILight* light = m_lights->pick(drand(), pickpdf);
+	if (light == nullptr) return 0;
+
+	double u1 = drand();
+	double u2 = drand();
+	double u3 = drand();
+	double u4 = drand();
+	LightSample sample;
+	vec3 dir;
+	double pdfdir;
+	if (!light->sample_emission(u1, u2, u3, u4, sample, dir, pdfdir)) return 0;
+
+	PathVertex& v = path[0];
+	v.type = PathVertex::LIGHT;
+	v.beta = sample.radiance;
+	v.p = sample.p;
+	v.normal = sample.normal;
+	v.light = light;
+	v.pickpdf = pickpdf;
+	v.delta = false;
+	v.pdffwd = pickpdf * sample.pdf;
+	v.pdfrev = 0.0;
+
+	vec3 beta = sample.radiance * (std::fabs(dot(sample.normal, dir)) / (pickpdf * sample.pdf * pdfdir));
+	if (max_comp(beta) <= 0.0) return 1;
+
+	vec3 escaped(0, 0, 0);
+	return random_walk(ray(sample.p, dir), beta, pdfdir, true, path, 1, escaped);
+}
+
+rt::vec3 rt::BidirectionalPathTracer::connect(const std::vector<PathVertex>& lightpath, const std::vector<PathVertex>& camerapath, size_t s, size_t t, size_t& pixel) const {
+	auto connectible = [](const PathVertex& v) {
+		return v.type == PathVertex::LIGHT || (v.type == PathVertex::SURFACE && !v.rec.material->is_specular());
+	};
+
+	vec3 contribution(0, 0, 0);
+	PathVertex sampled;
+	if (s == 0) {
+		// the camera subpath hit a light
+		const PathVertex& pt = camerapath[t - 1];
+		if (pt.type != PathVertex::SURFACE || !pt.rec.material->is_emissive()) return vec3(0);
+		contribution = pt.beta * pt.rec.material->emitted(pt.rec.u, pt.rec.v, pt.rec.lp);
+
+		// no other strategy finds lights that can't be sampled
+		if (pt.light == nullptr) return contribution;
+	}
+	else if (t == 1) {
+		// connect the light subpath to the camera
+		const PathVertex& qs = lightpath[s - 1];
+		if (!m_pinhole.enabled || !connectible(qs)) return vec3(0);
+
+		vec3 d = m_pinhole.origin - qs.p;
+		double distance = d.length();
+		vec3 wi = d / distance;
+		double pdfdir;
+		double importance = camera_importance(-wi, pdfdir, pixel);
+		if (importance <= 0.0) return vec3(0);
+
+		sampled.type = PathVertex::CAMERA;
+		sampled.p = m_pinhole.origin;
+		sampled.normal = m_pinhole.forward;
+		sampled.beta = vec3(importance * dot(-wi, m_pinhole.forward) / (distance * distance));
+		sampled.light = nullptr;
+		sampled.delta = false;
+		sampled.pdffwd = sampled.pdfrev = 0.0;
+
+		contribution = qs.beta * bsdf(qs, wi, true) * std::fabs(dot(qs.normal, wi)) * sampled.beta;
+		if (max_comp(contribution) <= 0.0) return vec3(0);
+		if (m_world->occluded(ray(qs.p, wi), SHADOW_EPSILON, distance - SHADOW_EPSILON)) return vec3(0);
+	}
+	else if (s == 1) {
+		// sample a point on a light like the raytracer does
+		const PathVertex& pt = camerapath[t - 1];
+		if (!connectible(pt)) return vec3(0);
+
+		sampler().start_bounce(CONNECT_STREAM + static_cast<uint32_t>(t));
+		double pickpdf;
+		const ILight* light = m_lights->pick(drand(), pickpdf);
+		if (light == nullptr) return vec3(0);
+
+		double u1 = drand();
+		double u2 = drand();
+		LightSample sample;
+		if (!light->sample(pt.p, u1, u2, sample)) return vec3(0);
+
+		vec3 d = sample.p - pt.p;
+		double distance = d.length();
+		vec3 wi = d / distance;
+
+		sampled.type = PathVertex::LIGHT;
+		sampled.p = sample.p;
+		sampled.normal = sample.normal;
+		sampled.beta = sample.radiance / (pickpdf * sample.pdf);
+		sampled.light = light;
+		sampled.pickpdf = pickpdf;
+		sampled.delta = false;
+		sampled.pdffwd = pdf_light_origin(sampled);
+		sampled.pdfrev = 0.0;
+
+		contribution = pt.beta * bsdf(pt, wi, false) * std::fabs(dot(pt.normal, wi)) * sampled.beta;
+		if (max_comp(contribution) <= 0.0) return vec3(0);
+		if (m_world->occluded(ray(pt.p, wi), SHADOW_EPSILON, distance - SHADOW_EPSILON)) return vec3(0);
+	}
+	else {
+		// connect two surfaces
+		const PathVertex& qs = lightpath[s - 1];
+		const PathVertex& pt = camerapath[t - 1];
+		if (!connectible(qs) || !connectible(pt)) return vec3(0);
+
+		vec3 d = pt.p - qs.p;
+		double distance2 = d.length2();
+		double distance = std::sqrt(distance2);
+		vec3 w = d / distance;
+
+		contribution = qs.beta * bsdf(qs, w, true) * bsdf(pt, -w, false) * pt.beta;
+		if (max_comp(contribution) <= 0.0) return vec3(0);
+		contribution *= std::fabs(dot(qs.normal, w)) * std::fabs(dot(pt.normal, w)) / distance2;
+		if (m_world->occluded(ray(qs.p, w), SHADOW_EPSILON, distance - SHADOW_EPSILON)) return vec3(0);
+	}
+
+	return contribution * mis_weight(lightpath, camerapath, sampled, s, t);
+}
+
+double rt::BidirectionalPathTracer::mis_weight(const std::vector<PathVertex>& lightpath, const std::vector<PathVertex>& camerapath, const PathVertex& sampled, size_t s, size_t t) const {
+	if (s + t == 2) return 1.0;
+
+	// end points of the subpaths, a vertex sampled by the
+	// connection replaces the end point of its subpath
+	const PathVertex* qs = (s == 1) ? &sampled : ((s > 1) ? &lightpath[s - 1] : nullptr);
+	const PathVertex* pt = (t == 1) ? &sampled : &camerapath[t - 1];
+	const PathVertex* qsminus = (s > 1) ? &lightpath[s - 2] : nullptr;
+	const PathVertex* ptminus = (t > 1) ? &camerapath[t - 2] : nullptr;
+
+	// the reverse densities next to the connection depend on the strategy
+	double ptrev = (s > 0) ? pdf(*qs, qsminus, *pt) : pdf_light_origin(*pt);
+	double ptminusrev = (ptminus == nullptr) ? 0.0 : ((s > 0) ? pdf(*pt, qs, *ptminus) : pdf_light(*pt, *ptminus));
+	double qsrev = (qs == nullptr) ? 0.0 : pdf(*pt, ptminus, *qs);
+	double qsminusrev = (qsminus == nullptr) ? 0.0 : pdf(*qs, pt, *qsminus);
+
+	// ratios of the densities of the strategies that move the connection
+	// towards the camera, the end points of the connection aren't delta
+	double sum = 0.0;
+	double ratio = 1.0;
+	for (size_t i = t - 1; i > 0; --i) {
+		const PathVertex& v = (i == t - 1) ? *pt : camerapath[i];
+		double rev = (i == t - 1) ? ptrev : ((i == t - 2) ? ptminusrev : v.pdfrev);
+		ratio *= remap_zero(rev) / remap_zero(v.pdffwd);
+		bool delta = (i == t - 1) ? false : v.delta;
+		if (!delta && !camerapath[i - 1].delta) sum += ratio;
+	}
+
+	// and towards the light, area lights are never delta
+	ratio = 1.0;
+	for (size_t i = s; i-- > 0;) {
+		const PathVertex& v = (i == s - 1) ? *qs : lightpath[i];
+		double rev = (i == s - 1) ? qsrev : ((i + 2 == s) ? qsminusrev : v.pdfrev);
+		ratio *= remap_zero(rev) / remap_zero(v.pdffwd);
+		bool delta = (i == s - 1) ? false : v.delta;
+		bool prevdelta = (i > 0) ? lightpath[i - 1].delta : false;
+		if (!delta && !prevdelta) sum += ratio;
+	}
+
+	return 1.0 / (1.0 + sum);
+}
+
+rt::vec3 rt::BidirectionalPathTracer::bsdf(const PathVertex& v, const vec3& w, bool lightpath) const {
+	if (v.type != PathVertex::SURFACE) return vec3(0);
+
+	// light arrives from the side of the light subpath
+	vec3 wo = lightpath ? w : v.wprev;
+	vec3 wi = lightpath ? v.wprev : w;
+	double cosine = dot(v.normal, wi);
+	if (cosine <= 0.0) return vec3(0);
+
+	return v.rec.material->eval(v.rec, wo, wi) / cosine;
+}
+
+double rt::BidirectionalPathTracer::pdf(const PathVertex& v, const PathVertex* prev, const PathVertex& next) const {
+	if (v.type == PathVertex::LIGHT) return pdf_light(v, next);
+
+	vec3 w = next.p - v.p;
+	double distance2 = w.length2();
+	if (distance2 <= 0.0) return 0.0;
+	w /= std::sqrt(distance2);
+
+	double pdfdir = 0.0;
+	if (v.type == PathVertex::CAMERA) {
+		size_t pixel;
+		camera_importance(w, pdfdir, pixel);
+	}
+	else if (prev != nullptr) {
+		pdfdir = v.rec.material->pdf(v.rec, normalize(prev->p - v.p), w);
+	}
+
+	return convert_density(pdfdir, v, next);
+}
+
+double rt::BidirectionalPathTracer::pdf_light(const PathVertex& v, const PathVertex& next) const {
+	if (v.light == nullptr) return 0.0;
+
+	vec3 w = next.p - v.p;
+	double distance2 = w.length2();
+	if (distance2 <= 0.0) return 0.0;
+	w /= std::sqrt(distance2);
+
+	double pdfpos, pdfdir;
+	v.light->pdf_emission(v.p, v.normal, w, pdfpos, pdfdir);
+	double pdf = pdfdir / distance2;
+	if (next.type != PathVertex::CAMERA) pdf *= std::fabs(dot(next.normal, w));
+	return pdf;
+}
+
+double rt::BidirectionalPathTracer::pdf_light_origin(const PathVertex& v) const {
+	if (v.light == nullptr) return 0.0;
+
+	double pdfpos, pdfdir;
+	v.light->pdf_emission(v.p, v.normal, v.normal, pdfpos, pdfdir);
+	return v.pickpdf * pdfpos;
+}
+
+double rt::BidirectionalPathTracer::convert_density(double pdf, const PathVertex& from, const PathVertex& to) const {
+	vec3 w = to.p - from.p;
+	double distance2 = w.length2();
+	if (distance2 <= 0.0) return 0.0;
+
+	// the camera is a point without a surface
+	if (to.type != PathVertex::CAMERA) pdf *= std::fabs(dot(to.normal, w)) / std::sqrt(distance2);
+	return pdf / distance2;
+}
+
+double rt::BidirectionalPathTracer::camera_importance(const vec3& dir, double& pdfdir, size_t& pixel) const {
+	pdfdir = 0.0;
+	double cosine = dot(dir, m_pinhole.forward);
+	if (!m_pinhole.enabled || cosine <= 0.0) return 0.0;
+
+	// intersect the direction with the image plane
+	vec3 d = m_pinhole.origin + dir * (m_pinhole.distance / cosine) - m_pinhole.upperleft;
+	double s = dot(d, m_pinhole.horizontal) / m_pinhole.horizontal.length2();
+	double t = dot(d, m_pinhole.vertical) / m_pinhole.vertical.length2();
+	if (s < 0.0 || s >= 1.0 || t < 0.0 || t >= 1.0) return 0.0;
+	pixel = std::min(static_cast<size_t>(s * m_width), m_width - 1) + std::min(static_cast<size_t>(t * m_height), m_height - 1) * m_width;
+
+	// the importance is normalized over the image plane, the
+	// density of a uniform point on it w.r.t. solid angle
+	double cosine2 = cosine * cosine;
+	pdfdir = 1.0 / (m_pinhole.area * cosine2 * cosine);
+	return 1.0 / (m_pinhole.area * cosine2 * cosine2);
+}
\ No newline at end of file
@@ -0,0 +1,177 @@
+#ifndef BIDIRECTIONAL_PATH_TRACER_H
+#define BIDIRECTIONAL_PATH_TRACER_H
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "itracer.h"
+#include "io/hdrimage.h"
+#include "io/console.h"
+#include "material/imaterial.h"
+#include "math/sampler.h"
+#include "parallel/parallel.h"
+#include "util/string.h"
+
+namespace rt {
+	/**
+	 * bidirectional path tracer by Veach. every sample traces a subpath from
+	 * the camera and one from a light and connects all pairs of their vertices.
+	 * the paths of the different strategies are combined by multiple importance
+	 * sampling with the balance heuristic. paths that end in the camera, the
+	 * light tracing strategy, land on an arbitrary pixel and are splatted into
+	 * a separate buffer. only materials that describe their scattering with
+	 * eval() and pdf() can be connected, all others count as specular
+	 */
+	class BidirectionalPathTracer : public ITracer {
+	public:
+		BidirectionalPathTracer(size_t width, size_t height, size_t samples, size_t maxdepth = 50);
+		BidirectionalPathTracer(Resolution r = Resolution::MEDIUM, Samples s = Samples::MEDIUM, TraceDepth t = TraceDepth::MEDIUM);
+
+		void setHitable(std::shared_ptr<IHitable> h)  override { m_world = h; }
+		void setLights(std::shared_ptr<LightList> l)  override { m_lights = l; }
+		void setCamera(std::shared_ptr <ICamera> cam) override { m_camera = cam; }
+		void setBackgroundColor(vec3 color) override { m_backgroundcolor = color; }
+		void setThreads(size_t threads) override { m_threads = threads; }
+
+		double aspect() const override { return static_cast<double>(m_width) / static_cast<double>(m_height); }
+
+		void run() override;
+		void write(std::string filepath) const override;
+
+	private:
+		/**
+		 * vertex of a camera or light subpath. the densities of sampling the
+		 * vertex from its neighbors are kept w.r.t. area, forward in the
+		 * direction the subpath was traced and reverse in the opposite one
+		 */
+		struct PathVertex {
+			enum Type { CAMERA, LIGHT, SURFACE };
+
+			Type          type;
+			vec3          beta;
+			vec3          p;
+			vec3          normal;
+			vec3          wprev;
+			HitRecord     rec;
+			const ILight* light;
+			double        pickpdf;
+			bool          delta;
+			double        pdffwd, pdfrev;
+		};
+
+		/**
+		 * pinhole through which light paths are connected to the image plane
+		 */
+		struct Pinhole {
+			bool   enabled;
+			vec3   origin;
+			vec3   forward;
+			vec3   upperleft;
+			vec3   horizontal;
+			vec3   vertical;
+			double distance;
+			double area;
+		};
+
+		HDRImage                  m_framebuffer;
+		std::shared_ptr<ICamera>  m_camera;
+		std::shared_ptr<IHitable> m_world;
+		std::shared_ptr<LightList> m_lights;
+		size_t                    m_width, m_height, m_samples, m_maxdepth;
+		size_t                    m_threads;
+		vec3                      m_backgroundcolor;
+		Pinhole                   m_pinhole;
+		std::vector<std::atomic<double>> m_splats;
+
+		/**
+		 * extends a subpath by following the scattered rays
+		 * @param r - ray leaving the last vertex of the path
+		 * @param beta - throughput of the ray
+		 * @param pdf - density of the direction of the ray w.r.t. solid angle
+		 * @param lightpath - true for light subpaths
+		 * @param path - vertices of the subpath, its size is the maximum length
+		 * @param count - number of vertices in the path
+		 * @param escaped - radiance of camera rays that leave the scene
+		 * @return number of vertices in the path
+		 */
+		size_t random_walk(ray r, vec3 beta, double pdf, bool lightpath, std::vector<PathVertex>& path, size_t count, vec3& escaped) const;
+		/**
+		 * traces a subpath starting at a light
+		 * @param path - vertices of the subpath, its size is the maximum length
+		 * @return number of vertices in the path
+		 */
+		size_t light_subpath(std::vector<PathVertex>& path) const;
+		/**
+		 * computes the contribution of the path that connects the first s
+		 * vertices of the light subpath with the first t of the camera subpath
+		 * @param lightpath - light subpath
+		 * @param camerapath - camera subpath
+		 * @param s - number of light vertices
+		 * @param t - number of camera vertices
+		 * @param pixel - pixel the contribution belongs to if t is 1
+		 * @return weighted contribution
+		 */
+		vec3 connect(const std::vector<PathVertex>& lightpath, const std::vector<PathVertex>& camerapath, size_t s, size_t t, size_t& pixel) const;
+		/**
+		 * multiple importance sampling weight of a strategy, computed from
+		 * the ratios of the densities of all strategies for the same path
+		 * @param lightpath - light subpath
+		 * @param camerapath - camera subpath
+		 * @param sampled - vertex sampled by the connection if s or t is 1
+		 * @param s - number of light vertices
+		 * @param t - number of camera vertices
+		 * @return balance heuristic weight
+		 */
+		double mis_weight(const std::vector<PathVertex>& lightpath, const std::vector<PathVertex>& camerapath, const PathVertex& sampled, size_t s, size_t t) const;
+
+		/**
+		 * scattering function of a vertex without the cosine
+		 * @param v - vertex to evaluate
+		 * @param w - normalized direction towards the connected vertex
+		 * @param lightpath - true if the vertex is part of a light subpath
+		 * @return fraction of the scattered light
+		 */
+		vec3 bsdf(const PathVertex& v, const vec3& w, bool lightpath) const;
+		/**
+		 * density of sampling a vertex from its neighbor
+		 * @param v - vertex that scatters
+		 * @param prev - vertex before v or nullptr
+		 * @param next - vertex that is sampled
+		 * @return pdf w.r.t. area at next
+		 */
+		double pdf(const PathVertex& v, const PathVertex* prev, const PathVertex& next) const;
+		/**
+		 * density of emitting light from a light vertex towards another vertex
+		 * @param v - vertex on a light
+		 * @param next - vertex that is sampled
+		 * @return pdf w.r.t. area at next
+		 */
+		double pdf_light(const PathVertex& v, const PathVertex& next) const;
+		/**
+		 * density of starting a light subpath at a vertex
+		 * @param v - vertex on a light
+		 * @return pdf w.r.t. area including picking the light
+		 */
+		double pdf_light_origin(const PathVertex& v) const;
+		/**
+		 * converts a density w.r.t. solid angle at one vertex to area at another one
+		 * @param pdf - density w.r.t. solid angle
+		 * @param from - vertex the direction starts at
+		 * @param to - vertex the direction points to
+		 * @return pdf w.r.t. area
+		 */
+		double convert_density(double pdf, const PathVertex& from, const PathVertex& to) const;
+		/**
+		 * importance that the pinhole camera assigns to a direction
+		 * @param dir - normalized direction leaving the camera
+		 * @param pdfdir - density of sampling the direction w.r.t. solid angle
+		 * @param pixel - pixel the direction passes through
+		 * @return importance, 0 if the direction misses the image plane
+		 */
+		double camera_importance(const vec3& dir, double& pdfdir, size_t& pixel) const;
+	};
+}
+
+#endif//BIDIRECTIONAL_PATH_TRACER_H
\ No newline at end of file
@@ -1,13 +1,13 @@
 #include "debugtracer.h"
 
 rt::Debugtracer::Debugtracer(unsigned int width, unsigned int height, unsigned int samples, size_t maxdepth)
-	: m_backgroundcolor(0, 0, 0), m_width(width), m_height(height), m_samples(samples), m_maxdepth(maxdepth), m_debugmode(DebugMode::POINTS),
+	: m_backgroundcolor(0, 0, 0), m_width(width), m_height(height), m_samples(samples), m_maxdepth(maxdepth), m_threads(0), m_debugmode(DebugMode::POINTS),
 	  m_linewidth(0.001), m_pointsize(0.01), m_renderer_width(width), m_renderer_height(height), m_renderer_samples(samples) {
 	m_raycaster = Raycaster(width, height, samples, 1);
 }
 
 rt::Debugtracer::Debugtracer(Resolution r, Samples s, TraceDepth t) 
-	: m_backgroundcolor(0, 0, 0), m_debugmode(DebugMode::POINTS), m_linewidth(0.001), m_pointsize(0.01) {
+	: m_threads(0), m_backgroundcolor(0, 0, 0), m_debugmode(DebugMode::POINTS), m_linewidth(0.001), m_pointsize(0.01) {
 	// determine resolution
 	auto [width, height] = determine_resolution(r);
 	m_width = width; m_height = height;
@@ -32,6 +32,10 @@ void rt::Debugtracer::run() {
 	console::println("MSAA  : " + std::to_string(m_samples));
 	console::println("DEPTH : " + std::to_string(m_maxdepth));
 
+	// setup worker threads
+	set_thread_count(m_threads);
+	console::println("THREADS: " + std::to_string(thread_pool().size()));
+
 	// initialize scene 
 	std::shared_ptr<BVH> scene = std::make_shared<BVH>(2, 20);
 	build_camera(scene);
@@ -106,45 +110,51 @@ void rt::Debugtracer::build_ray_scene(std::shared_ptr<BVH>& scene) {
 	auto redmaterial = std::make_shared<Lambertian>(new_color(vec3(1, 0, 0)));
 
 	// calculate step
-	size_t stepx = m_width / 50;
-	size_t stepy = m_height / 50;
-
-	// iterate over all pixels
-	size_t size = m_width * m_height;
-	for (size_t y = 0; y < m_height; y += stepy) {
-		for (size_t x = 0; x < m_width; x += stepx) {
-			// print progress
-			size_t i = x + y*m_width;
-			console::progress("build scene", static_cast<double>(i) / static_cast<double>(size - 1));
-
-			// trace ray and store all of it's intersection points
-			for (size_t s = 0; s < m_samples; ++s) {
-				double u = static_cast<double>(x + drand()) / static_cast<double>(m_width);
-				double v = static_cast<double>(y + drand()) / static_cast<double>(m_height);
-				ray r = m_camera->get_ray(u, v);
-
-				// trace ray and store its points
-				std::vector<vec3> raypoints;
-				raypoints.push_back(r.o);
-				trace(r, raypoints, 0);
-
-				// create debug primitives that will be visualized in the next step
-				for (size_t s = 1; s < raypoints.size(); ++s) {
-					switch (m_debugmode) {
-					case DebugMode::LINES:
-						// create a cylinder for each track of the ray
-						scene->insert(std::make_shared<Cylinder>(raypoints.at(s - 1), raypoints.at(s), m_linewidth, redmaterial));
-						break;
-					case DebugMode::POINTS:
-						// create spheres for each ray intersection
-						scene->insert(std::make_shared<Sphere>(raypoints.at(s), m_pointsize, redmaterial));
-						break;
+	size_t stepx = std::max(m_width / 50, size_t{1});
+	size_t stepy = std::max(m_height / 50, size_t{1});
+
+	// iterate over all pixels in parallel
+	std::mutex scenemutex;
+	render_tiles(m_width, m_height, "build scene", [&](const Tile& tile) {
+		std::vector<std::shared_ptr<IHitable>> primitives;
+		for (size_t y = tile.y0; y < tile.y1; ++y) {
+			if (y % stepy != 0) continue;
+			for (size_t x = tile.x0; x < tile.x1; ++x) {
+				if (x % stepx != 0) continue;
+
+				// trace ray and store all of it's intersection points
+				for (size_t s = 0; s < m_samples; ++s) {
+					sampler().start_sample(x + y * m_width, s);
+					double u = static_cast<double>(x + drand()) / static_cast<double>(m_width);
+					double v = static_cast<double>(y + drand()) / static_cast<double>(m_height);
+					ray r = m_camera->get_ray(u, v);
+
+					// trace ray and store its points
+					std::vector<vec3> raypoints;
+					raypoints.push_back(r.o);
+					trace(r, raypoints, 0);
+
+					// create debug primitives that will be visualized in the next step
+					for (size_t s = 1; s < raypoints.size(); ++s) {
+						switch (m_debugmode) {
+						case DebugMode::LINES:
+							// create a cylinder for each track of the ray
+							primitives.push_back(std::make_shared<Cylinder>(raypoints.at(s - 1), raypoints.at(s), m_linewidth, redmaterial));
+							break;
+						case DebugMode::POINTS:
+							// create spheres for each ray intersection
+							primitives.push_back(std::make_shared<Sphere>(raypoints.at(s), m_pointsize, redmaterial));
+							break;
+						}
 					}
-					
 				}
 			}
 		}
-	}
+
+		// the scene is shared among all threads
+		std::lock_guard<std::mutex> lock(scenemutex);
+		scene->insert_all(primitives);
+	});
 
 	// build scene
 	scene->build();
@@ -156,6 +166,9 @@ void rt::Debugtracer::build_ray_scene(std::shared_ptr<BVH>& scene) {
 }
 
 void rt::Debugtracer::trace(const ray& r, std::vector<vec3>& raypoints, int depth) const {
+	// each bounce draws from its own random sequence
+	sampler().start_bounce(depth + 1);
+
 	HitRecord rec;
 	if (m_world->hit(r, 0.001, FLT_MAX, rec)) {
 		ray scattered;
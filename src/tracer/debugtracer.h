@@ -2,6 +2,7 @@
 #define DEBUGTRACER_H
 
 #include <chrono>
+#include <mutex>
 #include <string>
 
 #include "hitable/object/cylinder.h"
@@ -13,6 +14,8 @@
 #include "material/dielectric.h"
 #include "material/imaterial.h"
 #include "material/lambertian.h"
+#include "math/sampler.h"
+#include "parallel/parallel.h"
 #include "tracer/raycaster.h"
 #include "tracer/raytracer.h"
 #include "texture/constanttexture.h"
@@ -33,6 +36,10 @@ namespace rt {
 		void setHitable(std::shared_ptr<IHitable> h)  override { m_world = h; }
 		void setCamera(std::shared_ptr <ICamera> cam) override { m_camera = cam; }
 		void setBackgroundColor(vec3 color) override { m_backgroundcolor = color; }
+		void setThreads(size_t threads) override {
+			m_threads = threads;
+			m_raycaster.setThreads(threads);
+		}
 		double aspect() const override { return static_cast<double>(m_width) / static_cast<double>(m_height); }
 
 		// debug tracer specific functions
@@ -43,10 +50,12 @@ namespace rt {
 			m_renderer_width = width;
 			m_renderer_height = height;
 			m_raycaster = Raycaster(m_renderer_width, m_renderer_height, m_renderer_samples, 1);
+			m_raycaster.setThreads(m_threads);
 		}
 		void setRendererSamples(size_t samples) { 
 			m_renderer_samples = samples;
 			m_raycaster = Raycaster(m_renderer_width, m_renderer_height, m_renderer_samples, 1);
+			m_raycaster.setThreads(m_threads);
 		}
 
 		// overwritten functions
@@ -58,6 +67,7 @@ namespace rt {
 		std::shared_ptr<ICamera>  m_camera;
 		std::shared_ptr<IHitable> m_world;
 		size_t                    m_width, m_height, m_samples, m_maxdepth;
+		size_t                    m_threads;
 		vec3                      m_backgroundcolor;
 		DebugMode                 m_debugmode;
 		// rendering related members
@@ -1,11 +1,13 @@
 #ifndef I_TRACER_H
 #define I_TRACER_H
 
+#include <cstdint>
 #include <string>
 #include <memory>
 #include <tuple>
 
 #include "hitable/ihitable.h"
+#include "light/lightlist.h"
 #include "scene/camera.h"
 #include "math/vec3.h"
 
@@ -103,6 +105,12 @@ namespace rt {
 		 * @param scene - hitable or organizing hitable that represents the scene
 		 */
 		virtual void setHitable(std::shared_ptr<IHitable> scene) = 0;
+		/**
+		 * setter for the lights that can be sampled explicitly,
+		 * tracers that don't sample lights ignore them
+		 * @param lights - emissive surfaces of the scene
+		 */
+		virtual void setLights(std::shared_ptr<LightList> /*lights*/) { }
 		/**
 		 * setter for the camera to use for tracing
 		 * @param camera - camera to trace rays from
@@ -113,6 +121,26 @@ namespace rt {
 		 * @param color - color of the background
 		 */
 		virtual void setBackgroundColor(vec3 color) = 0;
+		/**
+		 * setter for the number of threads used for tracing
+		 * @param threads - number of threads, 0 uses all hardware threads
+		 */
+		virtual void setThreads(size_t threads) = 0;
+		/**
+		 * setter for the path of the output image, tracers that write
+		 * intermediate images use it while running
+		 * @param filepath - path of the output png image
+		 */
+		virtual void setOutput(std::string /*filepath*/) { }
+		/**
+		 * setter for the checkpoint file, tracers that can't be
+		 * interrupted and resumed ignore it
+		 * @param filepath - path of the checkpoint file
+		 * @param resume - continue from the checkpoint if it exists
+		 * @param scenehash - hash of the scene file, only checkpoints of
+		 *                    the same scene are resumed
+		 */
+		virtual void setCheckpoint(std::string /*filepath*/, bool /*resume*/, uint64_t /*scenehash*/) { }
 
 		/**
 		 * returns the aspect ratio with/height of the output image
@@ -1,20 +1,289 @@
 #include "photonmapper.h"
 
-rt::PhotonMapper::PhotonMapper(unsigned int width, unsigned int height, unsigned int samples, size_t maxdepth) {
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
 
+#include "math/constants.h"
+
+namespace {
+	// number of bounces before russian roulette starts for camera paths
+	const size_t ROULETTE_DEPTH = 3;
+	// upper bound of the survival probability
+	const double ROULETTE_MAX_SURVIVAL = 0.95;
+	// offset of shadow rays from both of their end points
+	const double SHADOW_EPSILON = 0.001;
+	// photons that are emitted by one task
+	const size_t PHOTON_CHUNK_SIZE = 4096;
+	// photons draw from sequences that camera samples never use
+	const uint64_t PHOTON_SEQUENCE = 0xffffffff00000000ULL;
+	const uint64_t CAUSTIC_SEQUENCE = 0xffffffff00000001ULL;
+	// photons used by the density estimates
+	const size_t GLOBAL_NEIGHBORS = 100;
+	const size_t CAUSTIC_NEIGHBORS = 50;
+	// search radius of the estimates relative to the diagonal of the scene
+	const double GLOBAL_RADIUS = 0.1;
+	const double CAUSTIC_RADIUS = 0.025;
+}
+
+rt::PhotonMapper::PhotonMapper(unsigned int width, unsigned int height, unsigned int samples, size_t maxdepth)
+	: m_width(width), m_height(height), m_samples(samples), m_maxdepth(maxdepth), m_threads(0), m_backgroundcolor(0, 0, 0),
+	  m_photons(100000), m_caustics(100000), m_globalradius2(0.f), m_causticradius2(0.f) {
+	m_framebuffer = HDRImage(width, height);
 }
-rt::PhotonMapper::PhotonMapper(Resolution r, Samples s, TraceDepth t) {
 
+rt::PhotonMapper::PhotonMapper(Resolution r, Samples s, TraceDepth t)
+	: m_threads(0), m_backgroundcolor(0, 0, 0), m_photons(100000), m_caustics(100000), m_globalradius2(0.f), m_causticradius2(0.f) {
+	// determine resolution
+	auto [width, height] = determine_resolution(r);
+	m_width = width; m_height = height;
+	m_framebuffer = HDRImage(m_width, m_height);
+
+	// determine number of samples
+	m_samples = determine_samples(s);
+
+	// determine ray tracing depth
+	m_maxdepth = determine_trace_depth(t);
 }
 
 void rt::PhotonMapper::run() {
+	// print tracer settings
+	console::println("TYPE  : Photonmapper");
+	console::println("RES   : " + std::to_string(m_width) + "x" + std::to_string(m_height));
+	console::println("MSAA  : " + std::to_string(m_samples));
+	console::println("DEPTH : " + std::to_string(m_maxdepth));
+	console::println("LIGHTS: " + std::to_string((m_lights != nullptr) ? m_lights->size() : 0));
+
+	// setup worker threads
+	set_thread_count(m_threads);
+	console::println("THREADS: " + std::to_string(thread_pool().size()));
 
+	// start timer
+	auto starttime = std::chrono::high_resolution_clock::now();
+
+	// the search radii scale with the scene
+	aabb bounds;
+	double diagonal = m_world->boundingbox(bounds) ? (bounds.max() - bounds.min()).length() : 1.0;
+	m_globalradius2 = static_cast<float>(GLOBAL_RADIUS * GLOBAL_RADIUS * diagonal * diagonal);
+	m_causticradius2 = static_cast<float>(CAUSTIC_RADIUS * CAUSTIC_RADIUS * diagonal * diagonal);
+
+	// photon pass
+	m_globalmap.build(emit_photons(m_photons, false));
+	m_causticmap.build(emit_photons(m_caustics, true));
+	console::println("PHOTON: " + std::to_string(m_globalmap.size()) + " global, " + std::to_string(m_causticmap.size()) + " caustic stored");
+	auto photontime = std::chrono::high_resolution_clock::now();
+	console::println("EMIT  : " + format_time(std::chrono::duration_cast<std::chrono::duration<double>>(photontime - starttime).count()));
+
+	// render all tiles in parallel
+	render_tiles(m_width, m_height, "photonmapping", [&](const Tile& tile) {
+		for (size_t y = tile.y0; y < tile.y1; ++y) {
+			for (size_t x = tile.x0; x < tile.x1; ++x) {
+				// aggregate color for each sample
+				vec3 col(0, 0, 0);
+				for (size_t s = 0; s < m_samples; ++s) {
+					sampler().start_sample(x + y * m_width, s);
+					double u = static_cast<double>(x + drand()) / static_cast<double>(m_width);
+					double v = static_cast<double>(y + drand()) / static_cast<double>(m_height);
+					ray r = m_camera->get_ray(u, v);
+					col += trace(r);
+				}
+
+				// set pixel color
+				m_framebuffer.set(x, y, col / m_samples);
+			}
+		}
+	});
+
+	// print elapsed time
+	auto endtime = std::chrono::high_resolution_clock::now();
+	auto elapsedtime = std::chrono::duration_cast<std::chrono::duration<double>>(endtime - starttime);
+	console::println("elapsed time: " + format_time(elapsedtime.count()));
 }
 
 void rt::PhotonMapper::write(std::string filepath) const {
+	write_image(filepath, m_framebuffer);
+}
+
+std::vector<rt::Photon> rt::PhotonMapper::emit_photons(size_t count, bool caustics) const {
+	if (count == 0 || m_lights == nullptr || m_lights->empty()) return {};
+
+	// every chunk of photons has its own list, concatenating them in order
+	// keeps the photon maps independent of the number of threads
+	size_t chunks = (count + PHOTON_CHUNK_SIZE - 1) / PHOTON_CHUNK_SIZE;
+	std::vector<std::vector<Photon>> stored(chunks);
+	thread_pool().parallel_for(chunks, [&](size_t chunk) {
+		size_t begin = chunk * PHOTON_CHUNK_SIZE;
+		size_t end = std::min(begin + PHOTON_CHUNK_SIZE, count);
+		for (size_t i = begin; i < end; ++i) {
+			sampler().start_sample(i, caustics ? CAUSTIC_SEQUENCE : PHOTON_SEQUENCE);
+
+			// emit a photon from one of the lights
+			double u1 = drand();
+			double u2 = drand();
+			double u3 = drand();
+			double u4 = drand();
+			double u5 = drand();
+			ray r;
+			vec3 power;
+			if (!m_lights->emit(u1, u2, u3, u4, u5, r, power)) continue;
+
+			// each photon carries its share of the emitted power
+			power /= static_cast<double>(count);
+			trace_photon(r, power, caustics, stored[chunk]);
+		}
+	});
+
+	std::vector<Photon> photons;
+	for (auto& list : stored) photons.insert(photons.end(), list.begin(), list.end());
+	return photons;
+}
+
+void rt::PhotonMapper::trace_photon(ray r, vec3 power, bool caustics, std::vector<Photon>& photons) const {
+	// remembers if the photon passed a specular surface
+	bool specular = false;
+
+	for (size_t depth = 0; depth < m_maxdepth; ++depth) {
+		// each bounce draws from its own random sequence
+		sampler().start_bounce(depth + 1);
+
+		HitRecord rec;
+		if (!m_world->hit(r, 0.001, FLT_MAX, rec)) return;
+
+		if (rec.material->is_specular()) {
+			specular = true;
+		}
+		else if (caustics) {
+			if (specular) photons.emplace_back(rec.p, power, normalize(r.dir));
+			return;
+		}
+		else {
+			photons.emplace_back(rec.p, power, normalize(r.dir));
+		}
+
+		// the back of a diffuse surface doesn't reflect the photon,
+		// scatter() would send it through the surface
+		if (!rec.material->is_specular() && dot(rec.normal, r.dir) >= 0.0) return;
+		ray scattered;
+		vec3 attenuation;
+		if (!rec.material->scatter(r, rec, attenuation, scattered)) return;
+
+		// russian roulette with the reflectance, the surviving
+		// photons keep their power on average
+		double survival = std::min<double>(max_comp(attenuation), ROULETTE_MAX_SURVIVAL);
+		if (survival <= 0.0 || drand() >= survival) return;
+		power *= attenuation / survival;
 
+		r = scattered;
+	}
 }
 
 rt::vec3 rt::PhotonMapper::trace(const ray& r) const {
-	return vec3(0);
+	bool samplelights = m_lights != nullptr && !m_lights->empty();
+
+	vec3 radiance(0, 0, 0);
+	vec3 throughput(1, 1, 1);
+	ray current = r;
+
+	// set once the path left the first non specular surface
+	bool gathering = false;
+
+	for (size_t depth = 0; ; ++depth) {
+		// each bounce draws from its own random sequence
+		sampler().start_bounce(depth + 1);
+
+		HitRecord rec;
+		if (!m_world->hit(current, 0.001, FLT_MAX, rec)) {
+			radiance += throughput * m_backgroundcolor;
+			break;
+		}
+
+		// lights hit by the gather ray have been sampled explicitly, either
+		// at the first non specular surface or in the caustic map
+		if (!gathering || !samplelights) {
+			radiance += throughput * rec.material->emitted(rec.u, rec.v, rec.lp);
+		}
+
+		if (!rec.material->is_specular()) {
+			// the gather ray takes all the light from the global map
+			if (gathering) {
+				radiance += throughput * estimate_radiance(m_globalmap, GLOBAL_NEIGHBORS, m_globalradius2, current, rec);
+				break;
+			}
+
+			if (samplelights) radiance += throughput * sample_light(current, rec);
+			radiance += throughput * estimate_radiance(m_causticmap, CAUSTIC_NEIGHBORS, m_causticradius2, current, rec);
+			gathering = true;
+		}
+
+		// stop if the path ends here
+		ray scattered;
+		vec3 attenuation;
+		if (depth >= m_maxdepth || !rec.material->scatter(current, rec, attenuation, scattered)) break;
+		throughput *= attenuation;
+
+		// russian roulette, paths carrying little energy are likely
+		// to be terminated while the survivors are weighted up
+		if (depth + 1 >= ROULETTE_DEPTH) {
+			double survival = std::min<double>(max_comp(throughput), ROULETTE_MAX_SURVIVAL);
+			if (survival <= 0.0 || drand() >= survival) break;
+			throughput /= survival;
+		}
+
+		current = scattered;
+	}
+
+	return radiance;
+}
+
+rt::vec3 rt::PhotonMapper::sample_light(const ray& r, const HitRecord& rec) const {
+	// pick a light and a point on it
+	double pickpdf;
+	const ILight* light = m_lights->pick(drand(), pickpdf);
+	if (light == nullptr) return vec3(0);
+
+	double u1 = drand();
+	double u2 = drand();
+	LightSample sample;
+	if (!light->sample(rec.p, u1, u2, sample)) return vec3(0);
+
+	// the surface has to scatter light towards the viewer
+	vec3 wo = normalize(-r.dir);
+	vec3 d = sample.p - rec.p;
+	double distance = d.length();
+	vec3 wi = d / distance;
+	vec3 f = rec.material->eval(rec, wo, wi);
+	if (max_comp(f) <= 0.0 || max_comp(sample.radiance) <= 0.0) return vec3(0);
+
+	// shadow ray
+	if (m_world->occluded(ray(rec.p, wi), SHADOW_EPSILON, distance - SHADOW_EPSILON)) return vec3(0);
+
+	return f * sample.radiance / (pickpdf * sample.pdf);
+}
+
+rt::vec3 rt::PhotonMapper::estimate_radiance(const PhotonMap& map, size_t k, float maxdistance2, const ray& r, const HitRecord& rec) const {
+	if (map.empty()) return vec3(0);
+
+	thread_local std::vector<PhotonNeighbor> neighbors;
+	map.nearest(rec.p, k, maxdistance2, neighbors);
+	if (neighbors.empty()) return vec3(0);
+
+	vec3 wo = normalize(-r.dir);
+	vec3 flux(0, 0, 0);
+	for (const auto& neighbor : neighbors) {
+		const Photon& photon = map[neighbor.index];
+
+		// photons arriving at the other side of the surface don't contribute,
+		// eval() includes the cosine which the photon density already accounts for
+		vec3 wi(-photon.direction[0], -photon.direction[1], -photon.direction[2]);
+		double cosine = dot(rec.normal, wi);
+		if (cosine <= 0.0) continue;
+
+		vec3 f = rec.material->eval(rec, wo, wi) / cosine;
+		flux += f * vec3(photon.power[0], photon.power[1], photon.power[2]);
+	}
+
+	// the photons are spread over the disc that contains the k nearest,
+	// if fewer were found over the whole search disc
+	double radius2 = (neighbors.size() == k) ? neighbors.front().distance2 : maxdistance2;
+	return flux / (PI * radius2);
 }
\ No newline at end of file
@@ -1,18 +1,46 @@
 #ifndef PHOTON_MAPPER_H
 #define PHOTON_MAPPER_H
 
-#include "io/image.h"
+#include <chrono>
+#include <string>
+#include <vector>
+
 #include "itracer.h"
+#include "io/hdrimage.h"
+#include "io/console.h"
+#include "material/imaterial.h"
+#include "math/sampler.h"
+#include "parallel/parallel.h"
+#include "spatial/photonmap.h"
+#include "util/string.h"
 
 namespace rt {
+	/**
+	 * two pass photon mapper. the first pass emits photons from the lights
+	 * and stores them at non specular surfaces, all of them in the global
+	 * map and those that only passed specular surfaces in the caustic map.
+	 * the second pass follows camera rays through specular surfaces. at the
+	 * first non specular surface the direct light is sampled explicitly and
+	 * the caustics are estimated from the caustic map. the indirect light is
+	 * gathered with one more bounce, whose radiance is estimated from the
+	 * global map
+	 */
 	class PhotonMapper: public ITracer {
 	public:
 		PhotonMapper(unsigned int width, unsigned int height, unsigned int samples, size_t maxdepth = 50);
 		PhotonMapper(Resolution r = Resolution::MEDIUM, Samples s = Samples::MEDIUM, TraceDepth t = TraceDepth::MEDIUM);
 
 		void setHitable(std::shared_ptr<IHitable> h)  override { m_world = h; }
+		void setLights(std::shared_ptr<LightList> l)  override { m_lights = l; }
 		void setCamera(std::shared_ptr <ICamera> cam) override { m_camera = cam; }
 		void setBackgroundColor(vec3 color) override { m_backgroundcolor = color; }
+		void setThreads(size_t threads) override { m_threads = threads; }
+		/**
+		 * sets the number of photons that are emitted
+		 * @param photons - number of photons emitted for the global map
+		 * @param caustics - number of photons emitted for the caustic map
+		 */
+		void setPhotons(size_t photons, size_t caustics) { m_photons = photons; m_caustics = caustics; }
 
 		double aspect() const override { return static_cast<double>(m_width) / static_cast<double>(m_height); }
 
@@ -20,13 +48,59 @@ namespace rt {
 		void write(std::string filepath) const override;
 
 	private:
-		Image                     m_image;
-		std::shared_ptr<ICamera>  m_camera;
-		std::shared_ptr<IHitable> m_world;
-		unsigned int              m_width, m_height, m_samples, m_maxdepth;
-		vec3                      m_backgroundcolor;
+		HDRImage                   m_framebuffer;
+		std::shared_ptr<ICamera>   m_camera;
+		std::shared_ptr<IHitable>  m_world;
+		std::shared_ptr<LightList> m_lights;
+		unsigned int               m_width, m_height, m_samples;
+		size_t                     m_maxdepth;
+		size_t                     m_threads;
+		vec3                       m_backgroundcolor;
+		size_t                     m_photons, m_caustics;
+		PhotonMap                  m_globalmap, m_causticmap;
+		float                      m_globalradius2, m_causticradius2;
 
+		/**
+		 * emits photons from the lights in parallel
+		 * @param count - number of photons to emit
+		 * @param caustics - only keep photons that passed specular surfaces
+		 * @return photons stored at non specular surfaces
+		 */
+		std::vector<Photon> emit_photons(size_t count, bool caustics) const;
+		/**
+		 * follows a photon through the scene and stores it at the non
+		 * specular surfaces it hits. russian roulette based on the
+		 * reflectance decides if it continues
+		 * @param r - ray along which the photon leaves the light
+		 * @param power - power of the photon
+		 * @param caustics - only store the photon at the first non specular
+		 *                   surface and only if it passed a specular one before
+		 * @param photons - list the photons are appended to
+		 */
+		void trace_photon(ray r, vec3 power, bool caustics, std::vector<Photon>& photons) const;
+		/**
+		 * follows a camera ray and estimates the radiance arriving along it
+		 * @param r - primary ray
+		 * @return radiance arriving along the ray
+		 */
 		vec3 trace(const ray& r) const;
+		/**
+		 * samples the direct light arriving at a non specular surface
+		 * @param r - ray that hit the surface
+		 * @param rec - hit record of the surface
+		 * @return reflected radiance
+		 */
+		vec3 sample_light(const ray& r, const HitRecord& rec) const;
+		/**
+		 * estimates the reflected radiance from the density of the nearest photons
+		 * @param map - photon map to search
+		 * @param k - number of photons to use
+		 * @param maxdistance2 - squared search radius
+		 * @param r - ray that hit the surface
+		 * @param rec - hit record of the surface
+		 * @return reflected radiance
+		 */
+		vec3 estimate_radiance(const PhotonMap& map, size_t k, float maxdistance2, const ray& r, const HitRecord& rec) const;
 	};
 }
 
@@ -0,0 +1,301 @@
+#include "progressivephotonmapper.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#include "math/constants.h"
+
+namespace {
+	// upper bound of the survival probability of photons
+	const double ROULETTE_MAX_SURVIVAL = 0.95;
+	// offset of shadow rays from both of their end points
+	const double SHADOW_EPSILON = 0.001;
+	// photons that are traced by one task
+	const size_t PHOTON_CHUNK_SIZE = 4096;
+	// photons draw from sequences that camera samples never use,
+	// every iteration has its own sequence
+	const uint64_t PHOTON_SEQUENCE = 0xffffffff00000000ULL;
+	// gather radius of the first iteration relative to the diagonal of the scene
+	const double INITIAL_RADIUS = 0.01;
+	// fraction of the photons of an iteration that is kept, the radius
+	// shrinks accordingly. values below 1 make the estimate consistent
+	const double ALPHA = 2.0 / 3.0;
+}
+
+rt::ProgressivePhotonMapper::ProgressivePhotonMapper(unsigned int width, unsigned int height, unsigned int iterations, size_t maxdepth)
+	: m_width(width), m_height(height), m_iterations(iterations), m_maxdepth(maxdepth), m_threads(0), m_backgroundcolor(0, 0, 0),
+	  m_photons(100000), m_timebudget(0.0), m_interval(0.0) {
+	m_framebuffer = HDRImage(width, height);
+}
+
+rt::ProgressivePhotonMapper::ProgressivePhotonMapper(Resolution r, Samples s, TraceDepth t)
+	: m_threads(0), m_backgroundcolor(0, 0, 0), m_photons(100000), m_timebudget(0.0), m_interval(0.0) {
+	// determine resolution
+	auto [width, height] = determine_resolution(r);
+	m_width = width; m_height = height;
+	m_framebuffer = HDRImage(m_width, m_height);
+
+	// determine number of iterations
+	m_iterations = determine_samples(s);
+
+	// determine ray tracing depth
+	m_maxdepth = determine_trace_depth(t);
+}
+
+void rt::ProgressivePhotonMapper::run() {
+	// print tracer settings
+	console::println("TYPE  : SPPM");
+	console::println("RES   : " + std::to_string(m_width) + "x" + std::to_string(m_height));
+	console::println("ITER  : " + std::to_string(m_iterations));
+	console::println("PHOTON: " + std::to_string(m_photons) + " per iteration");
+	console::println("DEPTH : " + std::to_string(m_maxdepth));
+	console::println("LIGHTS: " + std::to_string((m_lights != nullptr) ? m_lights->size() : 0));
+
+	// setup worker threads
+	set_thread_count(m_threads);
+	console::println("THREADS: " + std::to_string(thread_pool().size()));
+
+	// start timer
+	auto starttime = std::chrono::high_resolution_clock::now();
+	auto elapsed = [&starttime]() {
+		auto now = std::chrono::high_resolution_clock::now();
+		return std::chrono::duration_cast<std::chrono::duration<double>>(now - starttime).count();
+	};
+	double lastwrite = 0.0;
+
+	// the gather radius scales with the scene
+	aabb bounds;
+	double diagonal = m_world->boundingbox(bounds) ? (bounds.max() - bounds.min()).length() : 1.0;
+	m_pixels = std::vector<Pixel>(m_width * m_height);
+	for (auto& pixel : m_pixels) {
+		pixel.direct = vec3(0, 0, 0);
+		pixel.radius = INITIAL_RADIUS * diagonal;
+		pixel.photons = 0.0;
+		pixel.flux = vec3(0, 0, 0);
+		pixel.visible = false;
+		for (auto& phi : pixel.phi) phi.store(0.0);
+		pixel.count.store(0);
+	}
+
+	std::vector<Tile> tiles = create_tiles(m_width, m_height);
+	std::vector<vec3> centers(m_pixels.size());
+	std::vector<double> radii(m_pixels.size());
+	bool emit = m_lights != nullptr && !m_lights->empty();
+	size_t chunks = (m_photons + PHOTON_CHUNK_SIZE - 1) / PHOTON_CHUNK_SIZE;
+
+	size_t iteration = 0;
+	console::progress("sppm", 0.0);
+	while (iteration < m_iterations) {
+		// one camera ray per pixel finds the visible points
+		thread_pool().parallel_for(tiles.size(), [&](size_t i) {
+			const Tile& tile = tiles[i];
+			for (size_t y = tile.y0; y < tile.y1; ++y) {
+				for (size_t x = tile.x0; x < tile.x1; ++x) {
+					sampler().start_sample(x + y * m_width, iteration);
+					double u = static_cast<double>(x + drand()) / static_cast<double>(m_width);
+					double v = static_cast<double>(y + drand()) / static_cast<double>(m_height);
+					trace_camera(m_camera->get_ray(u, v), m_pixels[x + y * m_width]);
+				}
+			}
+		});
+
+		if (emit) {
+			// the grid is rebuilt every iteration as the visible points move
+			for (size_t i = 0; i < m_pixels.size(); ++i) {
+				centers[i] = m_pixels[i].visible ? m_pixels[i].rec.p : vec3(0);
+				radii[i] = m_pixels[i].visible ? m_pixels[i].radius : 0.0;
+			}
+			m_grid.build(centers, radii);
+
+			// the photons of all chunks add their flux atomically
+			thread_pool().parallel_for(chunks, [&](size_t chunk) {
+				size_t begin = chunk * PHOTON_CHUNK_SIZE;
+				size_t end = std::min(begin + PHOTON_CHUNK_SIZE, m_photons);
+				for (size_t i = begin; i < end; ++i) {
+					sampler().start_sample(i, PHOTON_SEQUENCE + iteration);
+
+					// emit a photon from one of the lights
+					double u1 = drand();
+					double u2 = drand();
+					double u3 = drand();
+					double u4 = drand();
+					double u5 = drand();
+					ray r;
+					vec3 power;
+					if (m_lights->emit(u1, u2, u3, u4, u5, r, power)) trace_photon(r, power);
+				}
+			});
+		}
+
+		update_pixels();
+		++iteration;
+		console::progress("sppm", static_cast<double>(iteration) / static_cast<double>(m_iterations));
+
+		// stop once the time budget is used up
+		if (m_timebudget > 0.0 && elapsed() > m_timebudget) break;
+
+		// write the current state of the image from time to time
+		if (iteration < m_iterations && m_interval > 0.0 && !m_output.empty() && elapsed() - lastwrite >= m_interval) {
+			resolve(iteration);
+			write(m_output);
+			lastwrite = elapsed();
+			console::println("Saved intermediate result at " + m_output);
+		}
+	}
+	resolve(iteration);
+
+	// print elapsed time
+	if (iteration < m_iterations) console::println("ITER  : " + std::to_string(iteration) + " within the time budget");
+	console::println("elapsed time: " + format_time(elapsed()));
+}
+
+void rt::ProgressivePhotonMapper::write(std::string filepath) const {
+	write_image(filepath, m_framebuffer);
+}
+
+void rt::ProgressivePhotonMapper::trace_camera(const ray& r, Pixel& pixel) const {
+	bool samplelights = m_lights != nullptr && !m_lights->empty();
+
+	vec3 throughput(1, 1, 1);
+	ray current = r;
+	pixel.visible = false;
+
+	for (size_t depth = 0; ; ++depth) {
+		// each bounce draws from its own random sequence
+		sampler().start_bounce(depth + 1);
+
+		HitRecord rec;
+		if (!m_world->hit(current, 0.001, FLT_MAX, rec)) {
+			pixel.direct += throughput * m_backgroundcolor;
+			return;
+		}
+
+		// emission seen directly or over specular surfaces
+		pixel.direct += throughput * rec.material->emitted(rec.u, rec.v, rec.lp);
+
+		// the direct light at the visible point is sampled explicitly,
+		// the photons provide the indirect light
+		if (!rec.material->is_specular()) {
+			if (samplelights) pixel.direct += throughput * sample_light(current, rec);
+
+			pixel.rec = rec;
+			pixel.wo = normalize(-current.dir);
+			pixel.throughput = throughput;
+			pixel.visible = true;
+			return;
+		}
+
+		// follow the specular surfaces
+		ray scattered;
+		vec3 attenuation;
+		if (depth >= m_maxdepth || !rec.material->scatter(current, rec, attenuation, scattered)) return;
+		throughput *= attenuation;
+		if (max_comp(throughput) <= 0.0) return;
+
+		current = scattered;
+	}
+}
+
+void rt::ProgressivePhotonMapper::trace_photon(ray r, vec3 power) {
+	for (size_t depth = 0; depth < m_maxdepth; ++depth) {
+		// each bounce draws from its own random sequence
+		sampler().start_bounce(depth + 1);
+
+		HitRecord rec;
+		if (!m_world->hit(r, 0.001, FLT_MAX, rec)) return;
+
+		// the first hit is direct light, which the visible points sample explicitly
+		if (depth > 0 && !rec.material->is_specular()) {
+			vec3 wi = -normalize(r.dir);
+			auto [begin, end] = m_grid.candidates(rec.p);
+			for (const uint32_t* it = begin; it != end; ++it) {
+				Pixel& pixel = m_pixels[*it];
+				if ((pixel.rec.p - rec.p).length2() > pixel.radius * pixel.radius) continue;
+
+				// photons arriving at the other side of the surface don't contribute,
+				// eval() includes the cosine which the photon density already accounts for
+				double cosine = dot(pixel.rec.normal, wi);
+				if (cosine <= 0.0) continue;
+
+				vec3 phi = pixel.throughput * pixel.rec.material->eval(pixel.rec, pixel.wo, wi) / cosine * power;
+				for (int i = 0; i < 3; ++i) atomic_add(pixel.phi[i], phi[i]);
+				pixel.count.fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+
+		// the back of a diffuse surface doesn't reflect the photon,
+		// scatter() would send it through the surface
+		if (!rec.material->is_specular() && dot(rec.normal, r.dir) >= 0.0) return;
+		ray scattered;
+		vec3 attenuation;
+		if (!rec.material->scatter(r, rec, attenuation, scattered)) return;
+
+		// russian roulette with the reflectance, the surviving
+		// photons keep their power on average
+		double survival = std::min<double>(max_comp(attenuation), ROULETTE_MAX_SURVIVAL);
+		if (survival <= 0.0 || drand() >= survival) return;
+		power *= attenuation / survival;
+
+		r = scattered;
+	}
+}
+
+rt::vec3 rt::ProgressivePhotonMapper::sample_light(const ray& r, const HitRecord& rec) const {
+	// pick a light and a point on it
+	double pickpdf;
+	const ILight* light = m_lights->pick(drand(), pickpdf);
+	if (light == nullptr) return vec3(0);
+
+	double u1 = drand();
+	double u2 = drand();
+	LightSample sample;
+	if (!light->sample(rec.p, u1, u2, sample)) return vec3(0);
+
+	// the surface has to scatter light towards the viewer
+	vec3 wo = normalize(-r.dir);
+	vec3 d = sample.p - rec.p;
+	double distance = d.length();
+	vec3 wi = d / distance;
+	vec3 f = rec.material->eval(rec, wo, wi);
+	if (max_comp(f) <= 0.0 || max_comp(sample.radiance) <= 0.0) return vec3(0);
+
+	// shadow ray
+	if (m_world->occluded(ray(rec.p, wi), SHADOW_EPSILON, distance - SHADOW_EPSILON)) return vec3(0);
+
+	return f * sample.radiance / (pickpdf * sample.pdf);
+}
+
+void rt::ProgressivePhotonMapper::update_pixels() {
+	for (auto& pixel : m_pixels) {
+		uint32_t count = pixel.count.load(std::memory_order_relaxed);
+		vec3 phi(pixel.phi[0].load(std::memory_order_relaxed), pixel.phi[1].load(std::memory_order_relaxed), pixel.phi[2].load(std::memory_order_relaxed));
+		if (count > 0) {
+			// only a fraction of the new photons is kept, the radius shrinks
+			// such that the density of the kept photons stays the same
+			double photons = pixel.photons + ALPHA * count;
+			double radius = pixel.radius * std::sqrt(photons / (pixel.photons + count));
+			double shrink = (radius * radius) / (pixel.radius * pixel.radius);
+			pixel.flux = (pixel.flux + phi) * shrink;
+			pixel.photons = photons;
+			pixel.radius = radius;
+		}
+
+		for (auto& p : pixel.phi) p.store(0.0, std::memory_order_relaxed);
+		pixel.count.store(0, std::memory_order_relaxed);
+	}
+}
+
+void rt::ProgressivePhotonMapper::resolve(size_t iterations) {
+	if (iterations == 0) return;
+
+	// the flux was gathered from the photons of all iterations
+	double emitted = static_cast<double>(iterations) * static_cast<double>(m_photons);
+	for (size_t y = 0; y < m_height; ++y) {
+		for (size_t x = 0; x < m_width; ++x) {
+			const Pixel& pixel = m_pixels[x + y * m_width];
+			vec3 indirect = pixel.flux / (emitted * PI * pixel.radius * pixel.radius);
+			m_framebuffer.set(x, y, pixel.direct / static_cast<double>(iterations) + indirect);
+		}
+	}
+}
\ No newline at end of file
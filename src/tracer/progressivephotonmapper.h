@@ -0,0 +1,128 @@
+#ifndef PROGRESSIVE_PHOTON_MAPPER_H
+#define PROGRESSIVE_PHOTON_MAPPER_H
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "itracer.h"
+#include "io/hdrimage.h"
+#include "io/console.h"
+#include "material/imaterial.h"
+#include "math/sampler.h"
+#include "parallel/parallel.h"
+#include "spatial/hashgrid.h"
+#include "util/string.h"
+
+namespace rt {
+	/**
+	 * stochastic progressive photon mapper by Hachisuka and Jensen. every
+	 * iteration follows one camera ray per pixel through specular surfaces
+	 * to its first non specular surface, the visible point. the visible
+	 * points are put into a hash grid and a pass of photons is traced, each
+	 * photon adds its flux to the visible points whose gather radius contains
+	 * it. afterwards the radius of every pixel shrinks depending on the
+	 * photons it received, thus the estimate converges to the correct
+	 * solution while the memory only depends on the number of pixels
+	 */
+	class ProgressivePhotonMapper : public ITracer {
+	public:
+		ProgressivePhotonMapper(unsigned int width, unsigned int height, unsigned int iterations, size_t maxdepth = 50);
+		ProgressivePhotonMapper(Resolution r = Resolution::MEDIUM, Samples s = Samples::MEDIUM, TraceDepth t = TraceDepth::MEDIUM);
+
+		void setHitable(std::shared_ptr<IHitable> h)  override { m_world = h; }
+		void setLights(std::shared_ptr<LightList> l)  override { m_lights = l; }
+		void setCamera(std::shared_ptr <ICamera> cam) override { m_camera = cam; }
+		void setBackgroundColor(vec3 color) override { m_backgroundcolor = color; }
+		void setThreads(size_t threads) override { m_threads = threads; }
+		/**
+		 * sets the number of photons that are traced per iteration
+		 * @param photons - number of photons per iteration
+		 */
+		void setPhotons(size_t photons) { m_photons = photons; }
+		/**
+		 * limits the render time. iterations are rendered until either their
+		 * number is reached or the time budget is used up
+		 * @param timebudget - wall clock time in seconds, 0 renders all iterations
+		 * @param interval - seconds between intermediate images, 0 disables them
+		 */
+		void setProgressive(double timebudget, double interval) { m_timebudget = timebudget; m_interval = interval; }
+		void setOutput(std::string filepath) override { m_output = filepath; }
+
+		double aspect() const override { return static_cast<double>(m_width) / static_cast<double>(m_height); }
+
+		void run() override;
+		void write(std::string filepath) const override;
+
+	private:
+		/**
+		 * state of a pixel. the direct light is summed over all iterations,
+		 * the photons of the current iteration are accumulated atomically
+		 * and folded into the flux once the iteration is done
+		 */
+		struct Pixel {
+			vec3      direct;
+			double    radius;
+			double    photons;
+			vec3      flux;
+
+			// first non specular surface of the current iteration
+			HitRecord rec;
+			vec3      wo;
+			vec3      throughput;
+			bool      visible;
+
+			std::atomic<double>   phi[3];
+			std::atomic<uint32_t> count;
+		};
+
+		HDRImage                   m_framebuffer;
+		std::shared_ptr<ICamera>   m_camera;
+		std::shared_ptr<IHitable>  m_world;
+		std::shared_ptr<LightList> m_lights;
+		unsigned int               m_width, m_height, m_iterations;
+		size_t                     m_maxdepth;
+		size_t                     m_threads;
+		vec3                       m_backgroundcolor;
+		size_t                     m_photons;
+		double                     m_timebudget, m_interval;
+		std::string                m_output;
+		std::vector<Pixel>         m_pixels;
+		HashGrid                   m_grid;
+
+		/**
+		 * follows a camera ray to its first non specular surface and
+		 * stores the visible point of the pixel
+		 * @param r - primary ray
+		 * @param pixel - pixel of the ray
+		 */
+		void trace_camera(const ray& r, Pixel& pixel) const;
+		/**
+		 * follows a photon through the scene and adds its flux to all
+		 * visible points close to the non specular surfaces it hits
+		 * @param r - ray along which the photon leaves the light
+		 * @param power - power of the photon
+		 */
+		void trace_photon(ray r, vec3 power);
+		/**
+		 * samples the direct light arriving at a non specular surface
+		 * @param r - ray that hit the surface
+		 * @param rec - hit record of the surface
+		 * @return reflected radiance
+		 */
+		vec3 sample_light(const ray& r, const HitRecord& rec) const;
+		/**
+		 * shrinks the radius of all pixels and adds the photons of the
+		 * iteration to their flux
+		 */
+		void update_pixels();
+		/**
+		 * writes the estimate of all pixels into the framebuffer
+		 * @param iterations - number of finished iterations
+		 */
+		void resolve(size_t iterations);
+	};
+}
+
+#endif//PROGRESSIVE_PHOTON_MAPPER_H
\ No newline at end of file
@@ -1,15 +1,15 @@
 #include "raycaster.h"
 
 rt::Raycaster::Raycaster(unsigned int width, unsigned int height, unsigned int samples, size_t maxdepth)
-	: m_width(width), m_height(height), m_samples(samples), m_maxdepth(maxdepth) {
-	m_image = Image(m_width, m_height, 3);
+	: m_width(width), m_height(height), m_samples(samples), m_maxdepth(maxdepth), m_threads(0) {
+	m_framebuffer = HDRImage(m_width, m_height);
 }
 
-rt::Raycaster::Raycaster(Resolution r, Samples s, TraceDepth t) : m_backgroundcolor(0, 0, 0) {
+rt::Raycaster::Raycaster(Resolution r, Samples s, TraceDepth t) : m_threads(0), m_backgroundcolor(0, 0, 0) {
 	// determine resolution
 	auto [width, height] = determine_resolution(r);
 	m_width = width; m_height = height;
-	m_image = Image(m_width, m_height, 3);
+	m_framebuffer = HDRImage(m_width, m_height);
 
 	// determine number of samples
 	m_samples = determine_samples(s);
@@ -25,35 +25,33 @@ void rt::Raycaster::run() {
 	console::println("MSAA  : " + std::to_string(m_samples));
 	console::println("DEPTH : " + std::to_string(m_maxdepth));
 
+	// setup worker threads
+	set_thread_count(m_threads);
+	console::println("THREADS: " + std::to_string(thread_pool().size()));
+
 	// start timer
 	auto starttime = std::chrono::high_resolution_clock::now();
 
-	// iterate over all pixels
-	int size = m_width * m_height;
-	for (size_t i = 0; i < size; ++i) {
-		// print progress
-		console::progress("raycasting", static_cast<double>(i) / static_cast<double>(size - 1));
-
-		// determine x and y index
-		unsigned int x = i % m_width;
-		unsigned int y = i / m_width;
+	// render all tiles in parallel
+	render_tiles(m_width, m_height, "raycasting", [&](const Tile& tile) {
+		for (size_t y = tile.y0; y < tile.y1; ++y) {
+			for (size_t x = tile.x0; x < tile.x1; ++x) {
+				// aggregate color for each sample
+				vec3 col(0, 0, 0);
+				for (size_t s = 0; s < m_samples; ++s) {
+					sampler().start_sample(x + y * m_width, s);
+					double u = static_cast<double>(x + drand()) / static_cast<double>(m_width);
+					double v = static_cast<double>(y + drand()) / static_cast<double>(m_height);
+					ray r = m_camera->get_ray(u, v);
+					col += trace(r);
+				}
+				col /= m_samples;
 
-		// aggregate color for each sample
-		vec3 col(0, 0, 0);
-		for (size_t s = 0; s < m_samples; ++s) {
-			double u = static_cast<double>(x + drand()) / static_cast<double>(m_width);
-			double v = static_cast<double>(y + drand()) / static_cast<double>(m_height);
-			ray r = m_camera->get_ray(u, v);
-			col += trace(r);
+				// set pixel color
+				m_framebuffer.set(x, y, col);
+			}
 		}
-		col /= m_samples;
-
-		// gamma correction
-		col = sqrt(col);
-
-		// set pixel color
-		m_image.set(x, y, col);
-	}
+	});
 
 	// print elapsed time
 	auto endtime = std::chrono::high_resolution_clock::now();
@@ -62,10 +60,13 @@ void rt::Raycaster::run() {
 }
 
 void rt::Raycaster::write(std::string filepath) const {
-	write_image(filepath, m_image);
+	write_image(filepath, m_framebuffer);
 }
 
 rt::vec3 rt::Raycaster::trace(const ray& r) const {
+	// the first bounce draws from its own random sequence
+	sampler().start_bounce(1);
+
 	HitRecord rec;
 	if (m_world->hit(r, 0.001, FLT_MAX, rec)) {
 		ray scattered;
@@ -5,9 +5,11 @@
 #include <string>
 
 #include "itracer.h"
-#include "io/image.h"
+#include "io/hdrimage.h"
 #include "io/console.h"
 #include "material/imaterial.h"
+#include "math/sampler.h"
+#include "parallel/parallel.h"
 #include "util/string.h"
 
 namespace rt {
@@ -19,6 +21,7 @@ namespace rt {
 		void setHitable(std::shared_ptr<IHitable> h)  override { m_world = h; }
 		void setCamera(std::shared_ptr <ICamera> cam) override { m_camera = cam; }
 		void setBackgroundColor(vec3 color) override { m_backgroundcolor = color; }
+		void setThreads(size_t threads) override { m_threads = threads; }
 
 		double aspect() const override { return static_cast<double>(m_width) / static_cast<double>(m_height); }
 
@@ -26,10 +29,11 @@ namespace rt {
 		void write(std::string filepath) const override;
 
 	private:
-		Image                     m_image;
+		HDRImage                  m_framebuffer;
 		std::shared_ptr<ICamera>  m_camera;
 		std::shared_ptr<IHitable> m_world;
 		unsigned int              m_width, m_height, m_samples, m_maxdepth;
+		size_t                    m_threads;
 		vec3                      m_backgroundcolor;
 
 		vec3 trace(const ray& r) const;
@@ -1,18 +1,55 @@
 #include "raytracer.h"
 
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+
+#include "io/binary.h"
+
+namespace {
+	// number of bounces before russian roulette starts
+	const size_t ROULETTE_DEPTH = 3;
+	// upper bound of the survival probability, also paths with
+	// a high throughput get terminated eventually
+	const double ROULETTE_MAX_SURVIVAL = 0.95;
+	// offset of shadow rays from both of their end points
+	const double SHADOW_EPSILON = 0.001;
+	// luminances below are treated as this value when estimating the
+	// error, otherwise the gamma curve makes the error of black pixels explode
+	const double MIN_LUMINANCE = 1e-4;
+	// identifies checkpoint files and their layout
+	const uint32_t CHECKPOINT_MAGIC = 0x4b435452;
+	const uint32_t CHECKPOINT_VERSION = 2;
+
+	/**
+	 * power heuristic for combining two sampling strategies
+	 * @param pdf - density of the strategy that generated the sample
+	 * @param otherpdf - density of the other strategy
+	 * @return weight of the sample
+	 */
+	double power_heuristic(double pdf, double otherpdf) {
+		double a = pdf * pdf;
+		double b = otherpdf * otherpdf;
+		return (a + b > 0.0) ? a / (a + b) : 0.0;
+	}
+}
+
 rt::Raytracer::Raytracer(size_t width, size_t height, size_t samples, size_t maxdepth)
-	: m_width(width), m_height(height), m_samples(samples), m_maxdepth(maxdepth), m_backgroundcolor(0, 0, 0) {
-	m_image = Image(width, height, 3);
+	: m_width(width), m_height(height), m_samples(samples), m_maxdepth(maxdepth), m_threads(0), m_minsamples(samples), m_targeterror(0.0), m_timebudget(0.0), m_interval(0.0), m_passsamples(4), m_checkpointinterval(0.0), m_resume(false), m_scenehash(0), m_backgroundcolor(0, 0, 0) {
+	m_framebuffer = HDRImage(width, height);
 }
 
-rt::Raytracer::Raytracer(Resolution r, Samples s, TraceDepth t) : m_backgroundcolor(0,0,0) {
+rt::Raytracer::Raytracer(Resolution r, Samples s, TraceDepth t) : m_threads(0), m_targeterror(0.0), m_timebudget(0.0), m_interval(0.0), m_passsamples(4), m_checkpointinterval(0.0), m_resume(false), m_scenehash(0), m_backgroundcolor(0,0,0) {
 	// determine resolution
 	auto [width, height] = determine_resolution(r);
 	m_width = width; m_height = height;
-	m_image = Image(m_width, m_height, 3);
+	m_framebuffer = HDRImage(m_width, m_height);
 
 	// determine number of samples
 	m_samples = determine_samples(s);
+	m_minsamples = m_samples;
 
 	// determine ray tracing depth
 	m_maxdepth = determine_trace_depth(t);
@@ -24,35 +61,138 @@ void rt::Raytracer::run() {
 	console::println("RES   : " + std::to_string(m_width) + "x" + std::to_string(m_height));
 	console::println("MSAA  : " + std::to_string(m_samples));
 	console::println("DEPTH : " + std::to_string(m_maxdepth));
+	console::println("LIGHTS: " + std::to_string((m_lights != nullptr) ? m_lights->size() : 0));
+
+	// setup worker threads
+	set_thread_count(m_threads);
+	console::println("THREADS: " + std::to_string(thread_pool().size()));
+
+	// without a target error all pixels get the same number of samples,
+	// without progressive rendering they get all of them in a single pass
+	bool adaptive = m_targeterror > 0.0 && m_minsamples < m_samples;
+	bool progressive = m_timebudget > 0.0 || m_interval > 0.0 || m_checkpointinterval > 0.0;
+	size_t minsamples = adaptive ? std::max<size_t>(m_minsamples, 2) : 0;
+	size_t batch = progressive ? std::max<size_t>(m_passsamples, 1) : (adaptive ? minsamples : m_samples);
+	if (adaptive) console::println("ADAPT : min " + std::to_string(minsamples) + ", error " + std::to_string(m_targeterror));
+	if (progressive) {
+		std::string budget = (m_timebudget > 0.0) ? format_time(m_timebudget) : "unlimited";
+		console::println("TIME  : " + budget + ", " + std::to_string(batch) + " spp per pass");
+	}
 
-	// start timer
+	// each pass adds a batch of samples to the pixels that haven't converged.
+	// the sample indices continue over the passes, thus the random sequences
+	// don't depend on the number of passes
+	m_estimates.assign(m_width * m_height, PixelEstimate{ vec3(0, 0, 0), 0.0, 0.0, 0, false });
+	size_t pass = 0;
+	double resumedtime = 0.0;
+	if (m_resume && read_checkpoint(m_checkpoint, pass, resumedtime)) {
+		console::println("RESUME: pass " + std::to_string(pass) + " of " + m_checkpoint);
+	}
+	size_t remaining = std::count_if(m_estimates.begin(), m_estimates.end(), [](const PixelEstimate& e) { return !e.converged; });
+
+	// start timer, the time budget includes the time before resuming
 	auto starttime = std::chrono::high_resolution_clock::now();
+	auto elapsed = [&starttime, resumedtime]() {
+		auto now = std::chrono::high_resolution_clock::now();
+		return resumedtime + std::chrono::duration_cast<std::chrono::duration<double>>(now - starttime).count();
+	};
+	double lastwrite = resumedtime;
+	double lastcheckpoint = resumedtime;
+	bool outoftime = false;
+
+	while (remaining > 0 && !outoftime) {
+		// the first pass always covers the whole image, later passes skip
+		// their remaining tiles once the time budget is used up. the pixels
+		// of the skipped tiles simply end up with fewer samples
+		bool first = (++pass == 1);
+		size_t passsamples = first ? std::max(batch, minsamples) : batch;
+		std::string msg = (adaptive || progressive) ? "pass " + std::to_string(pass) : "raytracing";
+		render_tiles(m_width, m_height, msg, [&](const Tile& tile) {
+			if (!first && m_timebudget > 0.0 && elapsed() > m_timebudget) return;
+
+			for (size_t y = tile.y0; y < tile.y1; ++y) {
+				for (size_t x = tile.x0; x < tile.x1; ++x) {
+					PixelEstimate& estimate = m_estimates[x + y * m_width];
+					if (estimate.converged) continue;
+
+					// aggregate color for each sample
+					size_t end = std::min(estimate.count + passsamples, m_samples);
+					for (size_t s = estimate.count; s < end; ++s) {
+						sampler().start_sample(x + y * m_width, s);
+						double u = static_cast<double>(x + drand()) / static_cast<double>(m_width);
+						double v = static_cast<double>(y + drand()) / static_cast<double>(m_height);
+						ray r = m_camera->get_ray(u, v);
+						vec3 col = trace(r);
+						estimate.sum += col;
+
+						double luminance = 0.2126 * col[0] + 0.7152 * col[1] + 0.0722 * col[2];
+						estimate.luminance += luminance;
+						estimate.luminancesq += luminance * luminance;
+					}
+					estimate.count = end;
+
+					// the framebuffer keeps the linear radiance,
+					// tone mapping happens when the image is written
+					m_framebuffer.set(x, y, estimate.sum / estimate.count);
+				}
+			}
+		});
+
+		// pixels that missed a small feature like the edge of a light in all
+		// of their samples report no variance. the error is therefore taken
+		// as the maximum in a 3x3 window around the pixel
+		std::vector<double> errors(m_estimates.size());
+		for (size_t i = 0; i < m_estimates.size(); ++i) errors[i] = pixel_error(m_estimates[i]);
+
+		remaining = 0;
+		for (size_t y = 0; y < m_height; ++y) {
+			for (size_t x = 0; x < m_width; ++x) {
+				PixelEstimate& estimate = m_estimates[x + y * m_width];
+				if (estimate.converged) continue;
 
-	// iterate over all pixels
-	size_t size = m_width * m_height;
-	for (size_t i = 0; i < size; ++i) {
-		// print progress
-		console::progress("raytracing", static_cast<double>(i) / static_cast<double>(size - 1));
-
-		// determine x and y index
-		size_t x = i % m_width;
-		size_t y = i / m_width;
-
-		// aggregate color for each sample
-		vec3 col(0, 0, 0);
-		for (size_t s = 0; s < m_samples; ++s) {
-			double u = static_cast<double>(x + drand()) / static_cast<double>(m_width);
-			double v = static_cast<double>(y + drand()) / static_cast<double>(m_height);
-			ray r = m_camera->get_ray(u, v);
-			col += trace(r, 0);
+				double error = 0.0;
+				for (size_t wy = (y > 0) ? y - 1 : 0; wy < std::min(y + 2, m_height); ++wy) {
+					for (size_t wx = (x > 0) ? x - 1 : 0; wx < std::min(x + 2, m_width); ++wx) {
+						error = std::max(error, errors[wx + wy * m_width]);
+					}
+				}
+
+				estimate.converged = (estimate.count >= m_samples) || (adaptive && error <= m_targeterror);
+				if (!estimate.converged) ++remaining;
+			}
+		}
+
+		// write the current state of the image from time to time
+		outoftime = m_timebudget > 0.0 && elapsed() > m_timebudget;
+		if (remaining > 0 && !outoftime && m_interval > 0.0 && !m_output.empty() && elapsed() - lastwrite >= m_interval) {
+			write(m_output);
+			lastwrite = elapsed();
+			console::println("Saved intermediate result at " + m_output);
 		}
-		col /= m_samples;
 
-		// gamma correction
-		col = sqrt(col);
+		// checkpoints are only taken between passes, where all estimates
+		// are consistent. resuming continues with the next pass
+		if (remaining > 0 && !outoftime && m_checkpointinterval > 0.0 && !m_checkpoint.empty() && elapsed() - lastcheckpoint >= m_checkpointinterval) {
+			write_checkpoint(m_checkpoint, pass, elapsed());
+			lastcheckpoint = elapsed();
+			console::println("Saved checkpoint at " + m_checkpoint);
+		}
+	}
 
-		// set pixel color
-		m_image.set(x, y, col);
+	// the render is done, a later run must not resume it
+	if (!m_checkpoint.empty() && std::filesystem::exists(m_checkpoint)) {
+		std::error_code error;
+		std::filesystem::remove(m_checkpoint, error);
+		if (error) console::println("Could not remove checkpoint " + m_checkpoint);
+	}
+
+	// print the number of samples that were actually traced
+	if (outoftime) console::println("time budget used up after " + std::to_string(pass) + " passes");
+	if (adaptive || progressive) {
+		size_t total = 0;
+		for (const auto& estimate : m_estimates) total += estimate.count;
+		double average = static_cast<double>(total) / static_cast<double>(m_estimates.size());
+		console::println("SPP   : " + std::to_string(average) + " on average, " + std::to_string(total) + " samples");
 	}
 
 	// print elapsed time
@@ -62,22 +202,211 @@ void rt::Raytracer::run() {
 }
 
 void rt::Raytracer::write(std::string filepath) const {
-	write_image(filepath, m_image);
+	write_image(filepath, m_framebuffer);
+}
+
+void rt::Raytracer::write_checkpoint(const std::string& filepath, size_t pass, double elapsed) const {
+	std::vector<char> buffer;
+	put(buffer, CHECKPOINT_MAGIC);
+	put(buffer, CHECKPOINT_VERSION);
+	put(buffer, m_scenehash);
+	for (uint64_t setting : { m_width, m_height, m_samples, m_maxdepth, m_minsamples, m_passsamples }) put(buffer, setting);
+	put(buffer, m_targeterror);
+	put(buffer, static_cast<uint64_t>(pass));
+	put(buffer, elapsed);
+
+	// the random numbers of a sample only depend on the pixel and the
+	// sample index, thus the sample count is all state of the generator
+	for (const auto& estimate : m_estimates) {
+		put(buffer, static_cast<double>(estimate.sum.r));
+		put(buffer, static_cast<double>(estimate.sum.g));
+		put(buffer, static_cast<double>(estimate.sum.b));
+		put(buffer, estimate.luminance);
+		put(buffer, estimate.luminancesq);
+		put(buffer, static_cast<uint32_t>(estimate.count));
+		put(buffer, static_cast<uint8_t>(estimate.converged));
+	}
+
+	// write to a temporary file first, an interrupted write
+	// must not destroy the previous checkpoint
+	std::string temppath = filepath + ".tmp";
+	{
+		std::ofstream file(temppath, std::ios::binary);
+		file.write(buffer.data(), buffer.size());
+		if (!file) {
+			console::println("Could not write checkpoint " + temppath);
+			return;
+		}
+	}
+	std::error_code error;
+	std::filesystem::rename(temppath, filepath, error);
+	if (error) console::println("Could not write checkpoint " + filepath);
+}
+
+bool rt::Raytracer::read_checkpoint(const std::string& filepath, size_t& pass, double& elapsed) {
+	std::ifstream file(filepath, std::ios::binary);
+	if (!file) {
+		console::println("No checkpoint found at " + filepath + ", starting from scratch");
+		return false;
+	}
+
+	// the checkpoint has to belong to a render of the same scene file
+	// with the same settings
+	uint32_t magic = 0, version = 0;
+	uint64_t scenehash = 0;
+	get(file, magic);
+	get(file, version);
+	get(file, scenehash);
+	bool valid = magic == CHECKPOINT_MAGIC && version == CHECKPOINT_VERSION && scenehash == m_scenehash;
+	for (uint64_t setting : { m_width, m_height, m_samples, m_maxdepth, m_minsamples, m_passsamples }) {
+		uint64_t stored = 0;
+		get(file, stored);
+		valid = valid && stored == setting;
+	}
+	double targeterror = 0.0;
+	uint64_t storedpass = 0;
+	get(file, targeterror);
+	get(file, storedpass);
+	get(file, elapsed);
+	valid = valid && targeterror == m_targeterror;
+	if (!valid || !file) {
+		console::println("Checkpoint " + filepath + " doesn't match the scene, starting from scratch");
+		elapsed = 0.0;
+		return false;
+	}
+
+	std::vector<PixelEstimate> estimates(m_estimates.size());
+	for (auto& estimate : estimates) {
+		double r = 0.0, g = 0.0, b = 0.0;
+		uint32_t count = 0;
+		uint8_t converged = 0;
+		get(file, r);
+		get(file, g);
+		get(file, b);
+		get(file, estimate.luminance);
+		get(file, estimate.luminancesq);
+		get(file, count);
+		get(file, converged);
+		estimate.sum = vec3(r, g, b);
+		estimate.count = count;
+		estimate.converged = converged != 0;
+	}
+	if (!file) {
+		console::println("Checkpoint " + filepath + " is incomplete, starting from scratch");
+		elapsed = 0.0;
+		return false;
+	}
+
+	// restore the estimates and the image they represent
+	m_estimates = std::move(estimates);
+	for (size_t y = 0; y < m_height; ++y) {
+		for (size_t x = 0; x < m_width; ++x) {
+			const PixelEstimate& estimate = m_estimates[x + y * m_width];
+			if (estimate.count > 0) m_framebuffer.set(x, y, estimate.sum / estimate.count);
+		}
+	}
+	pass = storedpass;
+	return true;
 }
 
-rt::vec3 rt::Raytracer::trace(const ray& r, int depth) const {
-	HitRecord rec;
-	if (m_world->hit(r, 0.001, FLT_MAX, rec)) {
+double rt::Raytracer::pixel_error(const PixelEstimate& estimate) {
+	if (estimate.count < 2) return std::numeric_limits<double>::infinity();
+
+	// sample variance of the luminance and the standard error of its mean
+	double n = static_cast<double>(estimate.count);
+	double mean = estimate.luminance / n;
+	double variance = std::max(0.0, (estimate.luminancesq - n * mean * mean) / (n - 1.0));
+	double error = std::sqrt(variance / n);
+
+	// the error propagates through the gamma correction sqrt(x)
+	// with its derivative 1/(2*sqrt(x))
+	return error / (2.0 * std::sqrt(std::max(mean, MIN_LUMINANCE)));
+}
+
+rt::vec3 rt::Raytracer::trace(const ray& r) const {
+	bool samplelights = m_lights != nullptr && !m_lights->empty();
+
+	vec3 radiance(0, 0, 0);
+	vec3 throughput(1, 1, 1);
+	ray current = r;
+
+	// emission found by a scattered ray is weighted against light
+	// sampling, unless the previous surface didn't sample lights
+	bool specularbounce = true;
+	double scatterpdf = 0.0;
+	vec3 previous;
+
+	for (size_t depth = 0; ; ++depth) {
+		// each bounce draws from its own random sequence
+		sampler().start_bounce(depth + 1);
+
+		HitRecord rec;
+		if (!m_world->hit(current, 0.001, FLT_MAX, rec)) {
+			radiance += throughput * m_backgroundcolor;
+			break;
+		}
+
+		// add emitted light
+		vec3 emitted = rec.material->emitted(rec.u, rec.v, rec.lp);
+		if (max_comp(emitted) > 0.0) {
+			double weight = 1.0;
+			if (samplelights && !specularbounce) {
+				weight = power_heuristic(scatterpdf, m_lights->pdf(previous, rec));
+			}
+			radiance += throughput * emitted * weight;
+		}
+
+		// stop if the path ends here
 		ray scattered;
 		vec3 attenuation;
-		vec3 emitted = rec.material->emitted(rec.u, rec.v, rec.lp);
-		if (depth < m_maxdepth && rec.material->scatter(r, rec, attenuation, scattered)) {
-			return emitted + attenuation * trace(scattered, depth + 1);
-		} else {
-			return emitted;
+		if (depth >= m_maxdepth || !rec.material->scatter(current, rec, attenuation, scattered)) break;
+
+		// light arriving directly from a light source
+		specularbounce = rec.material->is_specular();
+		if (samplelights && !specularbounce) {
+			radiance += throughput * sample_light(current, rec);
+			scatterpdf = rec.material->pdf(rec, normalize(-current.dir), normalize(scattered.dir));
+			previous = rec.p;
 		}
+		throughput *= attenuation;
+
+		// russian roulette, paths carrying little energy are likely
+		// to be terminated while the survivors are weighted up
+		if (depth + 1 >= ROULETTE_DEPTH) {
+			double survival = std::min<double>(max_comp(throughput), ROULETTE_MAX_SURVIVAL);
+			if (survival <= 0.0 || drand() >= survival) break;
+			throughput /= survival;
+		}
+
+		current = scattered;
 	}
-	else {
-		return m_backgroundcolor;
-	}
+
+	return radiance;
+}
+
+rt::vec3 rt::Raytracer::sample_light(const ray& r, const HitRecord& rec) const {
+	// pick a light and a point on it
+	double pickpdf;
+	const ILight* light = m_lights->pick(drand(), pickpdf);
+	if (light == nullptr) return vec3(0);
+
+	double u1 = drand();
+	double u2 = drand();
+	LightSample sample;
+	if (!light->sample(rec.p, u1, u2, sample)) return vec3(0);
+
+	// the surface has to scatter light towards the viewer
+	vec3 wo = normalize(-r.dir);
+	vec3 d = sample.p - rec.p;
+	double distance = d.length();
+	vec3 wi = d / distance;
+	vec3 f = rec.material->eval(rec, wo, wi);
+	if (max_comp(f) <= 0.0 || max_comp(sample.radiance) <= 0.0) return vec3(0);
+
+	// shadow ray
+	if (m_world->occluded(ray(rec.p, wi), SHADOW_EPSILON, distance - SHADOW_EPSILON)) return vec3(0);
+
+	double lightpdf = pickpdf * sample.pdf;
+	double weight = power_heuristic(lightpdf, rec.material->pdf(rec, wo, wi));
+	return f * sample.radiance * (weight / lightpdf);
 }
\ No newline at end of file
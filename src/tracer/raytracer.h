@@ -3,11 +3,14 @@
 
 #include <chrono>
 #include <string>
+#include <vector>
 
 #include "itracer.h"
-#include "io/image.h"
+#include "io/hdrimage.h"
 #include "io/console.h"
 #include "material/imaterial.h"
+#include "math/sampler.h"
+#include "parallel/parallel.h"
 #include "util/string.h"
 
 namespace rt {
@@ -17,8 +20,37 @@ namespace rt {
 		Raytracer(Resolution r = Resolution::MEDIUM, Samples s = Samples::MEDIUM, TraceDepth t = TraceDepth::MEDIUM);
 
 		void setHitable(std::shared_ptr<IHitable> h)  override { m_world = h; }
+		void setLights(std::shared_ptr<LightList> l)  override { m_lights = l; }
 		void setCamera(std::shared_ptr <ICamera> cam) override { m_camera = cam; }
 		void setBackgroundColor(vec3 color) override { m_backgroundcolor = color; }
+		void setThreads(size_t threads) override { m_threads = threads; }
+		/**
+		 * enables adaptive sampling. every pixel gets the minimal number of
+		 * samples first, further samples are only spent on pixels whose
+		 * estimated error, or the one of a neighbor, is still above the
+		 * target. the number of samples of the tracer is the maximum per pixel
+		 * @param minsamples - number of samples every pixel gets
+		 * @param targeterror - standard error of the gamma corrected pixel
+		 *                      value in [0,1], 0 disables adaptive sampling
+		 */
+		void setAdaptive(size_t minsamples, double targeterror) { m_minsamples = minsamples; m_targeterror = targeterror; }
+		/**
+		 * enables progressive rendering. the whole image is rendered in passes
+		 * of a few samples per pixel until either the number of samples of the
+		 * tracer is reached or the time budget is used up
+		 * @param timebudget - wall clock time in seconds, 0 renders all samples
+		 * @param interval - seconds between intermediate images, 0 disables them
+		 * @param passsamples - number of samples per pixel and pass
+		 */
+		void setProgressive(double timebudget, double interval, size_t passsamples) { m_timebudget = timebudget; m_interval = interval; m_passsamples = passsamples; }
+		/**
+		 * sets how often a checkpoint is written. checkpointing renders
+		 * progressively, the result doesn't change however
+		 * @param interval - seconds between checkpoints, 0 disables them
+		 */
+		void setCheckpointInterval(double interval) { m_checkpointinterval = interval; }
+		void setOutput(std::string filepath) override { m_output = filepath; }
+		void setCheckpoint(std::string filepath, bool resume, uint64_t scenehash) override { m_checkpoint = filepath; m_resume = resume; m_scenehash = scenehash; }
 	
 		double aspect() const override { return static_cast<double>(m_width) / static_cast<double>(m_height); }
 
@@ -26,13 +58,75 @@ namespace rt {
 		void write(std::string filepath) const override;
 
 	private:
-		Image                     m_image;
+		/**
+		 * running estimate of a pixel. besides the sum of the colors the sum
+		 * of the luminance and its square are kept to estimate the variance
+		 */
+		struct PixelEstimate {
+			vec3   sum;
+			double luminance;
+			double luminancesq;
+			size_t count;
+			bool   converged;
+		};
+
+		HDRImage                  m_framebuffer;
 		std::shared_ptr<ICamera>  m_camera;
 		std::shared_ptr<IHitable> m_world;
+		std::shared_ptr<LightList> m_lights;
 		size_t                    m_width, m_height, m_samples, m_maxdepth;
+		size_t                    m_threads;
+		size_t                    m_minsamples;
+		double                    m_targeterror;
+		double                    m_timebudget, m_interval;
+		size_t                    m_passsamples;
+		std::string               m_output;
+		double                    m_checkpointinterval;
+		std::string               m_checkpoint;
+		bool                      m_resume;
+		uint64_t                  m_scenehash;
 		vec3                      m_backgroundcolor;
+		std::vector<PixelEstimate> m_estimates;
 
-		vec3 trace(const ray& r, int depth) const;
+		/**
+		 * follows a path starting with the specified ray. at non specular
+		 * surfaces a light is sampled explicitly and combined with the
+		 * scattered ray by multiple importance sampling. after a minimal
+		 * depth paths are terminated by russian roulette based on their
+		 * throughput, the surviving paths are weighted up accordingly
+		 * @param r - primary ray
+		 * @return radiance arriving along the ray
+		 */
+		vec3 trace(const ray& r) const;
+		/**
+		 * samples the direct light arriving at a non specular surface
+		 * @param r - ray that hit the surface
+		 * @param rec - hit record of the surface
+		 * @return reflected radiance weighted for multiple importance sampling
+		 */
+		vec3 sample_light(const ray& r, const HitRecord& rec) const;
+		/**
+		 * estimates the standard error of the gamma corrected pixel value
+		 * @param estimate - running estimate of the pixel
+		 * @return error of the pixel, infinity for less than two samples
+		 */
+		static double pixel_error(const PixelEstimate& estimate);
+		/**
+		 * writes the settings, the pass and the estimates of all pixels
+		 * @param filepath - path of the checkpoint file
+		 * @param pass - number of passes that are completed
+		 * @param elapsed - rendering time so far in seconds
+		 */
+		void write_checkpoint(const std::string& filepath, size_t pass, double elapsed) const;
+		/**
+		 * restores the estimates of all pixels and the image from a
+		 * checkpoint, if it was written with the same settings
+		 * @param filepath - path of the checkpoint file
+		 * @param pass - number of passes that were completed
+		 * @param elapsed - rendering time before the checkpoint in seconds
+		 * @return true if the checkpoint was restored
+		 */
+		bool read_checkpoint(const std::string& filepath, size_t& pass, double& elapsed);
 	};
 }
 
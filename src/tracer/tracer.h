@@ -1,8 +1,11 @@
 #ifndef TRACER_H
 #define TRACER_H
 
+#include "bidirectionalpathtracer.h"
 #include "debugtracer.h"
 #include "itracer.h"
+#include "photonmapper.h"
+#include "progressivephotonmapper.h"
 #include "raycaster.h"
 #include "raytracer.h"
 
@@ -4,6 +4,7 @@
 #include <algorithm>
 #include <sstream>
 #include <cctype>
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -102,6 +103,19 @@ namespace rt {
 
 		return hh + ':' + mm + ':' + ss + '.' + mms;
 	}
+
+	/**
+	 * 64 bit fnv-1a hash of a string. unlike std::hash it is the same
+	 * on all platforms, thus it can be stored in files
+	 */
+	inline uint64_t hash_string(const std::string& s) {
+		uint64_t hash = 14695981039346656037ull;
+		for (unsigned char c : s) {
+			hash ^= c;
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
 }
 
 #endif//STRING_UTIL_H
\ No newline at end of file